@@ -32,6 +32,13 @@ include/ImGuizmo/ImGuizmo.cpp ^
 src/engine/components/light.cpp ^
 src/engine/components/meshrenderer.cpp ^
 src/engine/components/script_component.cpp ^
+src/engine/components/collider_component.cpp ^
+src/engine/components/first_person_controller.cpp ^
+src/engine/jobs/job_system.cpp ^
+src/engine/systems/system_scheduler.cpp ^
+src/engine/math/transform_kernel.cpp ^
+src/engine/math/frustum.cpp ^
+src/engine/math/bvh.cpp ^
 src/engine/scripting/lua_context.cpp ^
 src/engine/scripting/lua_binding.cpp ^
 %INCLUDE_FLAGS% %LIB_FLAGS%
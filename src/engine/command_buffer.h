@@ -0,0 +1,122 @@
+/**
+ * @file command_buffer.h
+ * @brief Records structural scene changes so they can be applied at a safe point
+ */
+#pragma once
+#include <functional>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include "gameobject.h"
+#include "gameobject_handle.h"
+
+/**
+ * @brief List of pending creates, removes and component changes.
+ *
+ * Adding or removing objects or components while the scene is being iterated would
+ * shift arrays and invalidate views mid-loop. Code that runs during iteration (systems,
+ * scripts, editor panels) records the change here instead, and Scene::flushCommands()
+ * applies every recorded command in one batch at the next sync point. The Scene keeps
+ * one buffer per job thread, so recording never takes a lock, plus one shared buffer
+ * for every other thread, which locks around each access.
+ */
+class CommandBuffer
+{
+public:
+    struct Command
+    {
+        enum class Kind
+        {
+            Create, // Spawn an object called name, then run apply on it
+            Remove, // Remove target
+            Modify  // Run apply on target, if it still exists
+        };
+
+        Kind kind;
+        GameObjectHandle target;
+        std::string name;
+        std::function<void(GameObject &)> apply;
+    };
+
+    // A shared buffer may be recorded into from several threads at once
+    explicit CommandBuffer(bool shared = false) : shared(shared) {}
+
+    CommandBuffer(const CommandBuffer &) = delete;
+    CommandBuffer &operator=(const CommandBuffer &) = delete;
+
+    // The object only exists after the flush; use init to set it up
+    void createGameObject(const std::string &name, std::function<void(GameObject &)> init = {})
+    {
+        record({Command::Kind::Create, {}, name, std::move(init)});
+    }
+
+    void removeGameObject(GameObjectHandle handle)
+    {
+        record({Command::Kind::Remove, handle, {}, {}});
+    }
+
+    template <typename T>
+    void addComponent(GameObjectHandle handle, std::function<void(T &)> init = {})
+    {
+        modify(handle, [init = std::move(init)](GameObject &gameObject)
+        {
+            T *component = gameObject.addComponent<T>();
+            if (init)
+            {
+                init(*component);
+            }
+        });
+    }
+
+    template <typename T>
+    void removeComponent(GameObjectHandle handle)
+    {
+        modify(handle, [](GameObject &gameObject)
+        {
+            gameObject.removeComponent<T>();
+        });
+    }
+
+    // Any other deferred change to an existing object
+    void modify(GameObjectHandle handle, std::function<void(GameObject &)> fn)
+    {
+        record({Command::Kind::Modify, handle, {}, std::move(fn)});
+    }
+
+    bool empty()
+    {
+        std::unique_lock<std::mutex> lock = lockIfShared();
+        return commands.empty();
+    }
+
+    void clear()
+    {
+        std::unique_lock<std::mutex> lock = lockIfShared();
+        commands.clear();
+    }
+
+    // Hands the recorded commands over in exchange for an empty list. Swapping instead of
+    // copying keeps both capacities, so steady traffic doesn't reallocate every frame.
+    void swap(std::vector<Command> &other)
+    {
+        std::unique_lock<std::mutex> lock = lockIfShared();
+        commands.swap(other);
+    }
+
+private:
+    void record(Command command)
+    {
+        std::unique_lock<std::mutex> lock = lockIfShared();
+        commands.push_back(std::move(command));
+    }
+
+    std::unique_lock<std::mutex> lockIfShared()
+    {
+        return shared ? std::unique_lock<std::mutex>(mutex) : std::unique_lock<std::mutex>();
+    }
+
+    std::vector<Command> commands;
+    std::mutex mutex; // Only taken by the shared buffer
+    bool shared;
+};
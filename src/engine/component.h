@@ -6,7 +6,10 @@
 #pragma once
 #include <string>
 #include <memory>
+#include <type_traits>
 #include "serialization.h"
+#include "ecs/component_pool.h"
+#include "ecs/component_type.h"
 #include "../renderer/shader.h"
 
 // Forward declarations
@@ -19,8 +22,13 @@ protected:
     GameObject *owner;
     bool enabled;
 
+private:
+    ComponentTypeId typeId;
+    IComponentPool *pool; // Told when this component starts or stops running
+    bool ownerActive;
+
 public:
-    Component() : owner(nullptr), enabled(true) {}
+    Component() : owner(nullptr), enabled(true), typeId(MaxComponentTypes), pool(nullptr), ownerActive(true) {}
     virtual ~Component() = default;
 
     virtual void Start() {}
@@ -45,10 +53,63 @@ public:
 
     void setEnabled(bool value)
     {
+        if (enabled == value)
+            return;
         enabled = value;
+        if (pool)
+        {
+            pool->markActiveDirty();
+        }
+    }
+
+    // Enabled and on an active object: only running components get their hooks called
+    bool isRunning() const
+    {
+        return enabled && ownerActive;
+    }
+
+    // Set by GameObject::setActive
+    void setOwnerActive(bool value)
+    {
+        if (ownerActive == value)
+            return;
+        ownerActive = value;
+        if (pool)
+        {
+            pool->markActiveDirty();
+        }
+    }
+
+    void setPool(IComponentPool *newPool)
+    {
+        pool = newPool;
+    }
+
+    // Set by GameObject::addComponent to the concrete type's id
+    void setTypeId(ComponentTypeId id)
+    {
+        typeId = id;
+    }
+
+    ComponentTypeId getTypeId() const
+    {
+        return typeId;
+    }
+
+    // Exact type checks: an integer compare, no RTTI or string allocation
+    template <typename T>
+    bool is() const
+    {
+        return typeId == componentTypeId<T>();
+    }
+
+    template <typename T>
+    T *as()
+    {
+        return is<T>() ? static_cast<T *>(this) : nullptr;
     }
 
-    virtual std::string getTypeName() const = 0;
+    virtual const char *getTypeName() const = 0;
 
     // Serialization
     virtual void serialize(json &j) const override
@@ -59,6 +120,14 @@ public:
 
     virtual void deserialize(const json &j) override
     {
-        enabled = j["enabled"].get<bool>();
+        setEnabled(j["enabled"].get<bool>());
     }
 };
+
+// True if T overrides the hook. A type that doesn't inherits Component's empty one, so
+// &T::Update is still a pointer to a member of Component.
+template <typename T>
+constexpr bool hasUpdateHook = !std::is_same<decltype(&T::Update), decltype(&Component::Update)>::value;
+
+template <typename T>
+constexpr bool hasRenderHook = !std::is_same<decltype(&T::Render), decltype(&Component::Render)>::value;
@@ -0,0 +1,150 @@
+/**
+ * @file component_factory.h
+ * @brief Registry of component constructors, keyed by hashed type name
+ */
+#pragma once
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include "component.h"
+#include "ecs/component_type.h"
+#include "ecs/entity_registry.h"
+#include "../helpers/logging.h"
+
+/**
+ * @brief Everything needed to build a component from its serialized type name.
+ *
+ * clone builds a component from a prototype of the same type, for prefab instances.
+ * update and render run the type's hook on every running instance, with a direct
+ * (non-virtual) call. They are null when the type leaves the hook empty, so types
+ * without per-frame work cost nothing per frame.
+ */
+struct ComponentType
+{
+    const char *name;
+    uint64_t nameHash;
+    ComponentTypeId id;
+    Component *(*create)(EntityRegistry &registry, Entity entity);
+    Component *(*clone)(EntityRegistry &registry, Entity entity, const Component &prototype);
+    void (*update)(EntityRegistry &registry, float deltaTime);
+    void (*render)(EntityRegistry &registry, Shader &shader);
+};
+
+class ComponentFactory
+{
+public:
+    static ComponentFactory &getInstance()
+    {
+        static ComponentFactory instance;
+        return instance;
+    }
+
+    ComponentFactory(const ComponentFactory &) = delete;
+    ComponentFactory &operator=(const ComponentFactory &) = delete;
+
+    template <typename T>
+    void registerType(const char *name)
+    {
+        ComponentType type{
+            name,
+            hashTypeName(name),
+            componentTypeId<T>(),
+            [](EntityRegistry &registry, Entity entity) -> Component *
+            {
+                return registry.emplace<T>(entity);
+            },
+            [](EntityRegistry &registry, Entity entity, const Component &prototype) -> Component *
+            {
+                if constexpr (std::is_copy_constructible<T>::value)
+                {
+                    return registry.emplace<T>(entity, static_cast<const T &>(prototype));
+                }
+                else
+                {
+                    // Types that own something unique (a Lua state) rebuild it from data
+                    json data;
+                    prototype.serialize(data);
+                    T *component = registry.emplace<T>(entity);
+                    component->deserialize(data);
+                    return component;
+                }
+            },
+            nullptr,
+            nullptr};
+
+        if constexpr (hasUpdateHook<T>)
+        {
+            type.update = [](EntityRegistry &registry, float deltaTime)
+            {
+                for (T *component : registry.active<T>())
+                {
+                    component->T::Update(deltaTime);
+                }
+            };
+        }
+        if constexpr (hasRenderHook<T>)
+        {
+            type.render = [](EntityRegistry &registry, Shader &shader)
+            {
+                for (T *component : registry.active<T>())
+                {
+                    component->T::Render(shader);
+                }
+            };
+        }
+
+        auto [it, inserted] = types.emplace(type.nameHash, type);
+        if (!inserted)
+        {
+            if (it->second.id != type.id)
+            {
+                LOG_ERROR("Component type {} collides with {}", name, it->second.name);
+            }
+            return;
+        }
+        order.push_back(type.nameHash);
+    }
+
+    // One hash probe per lookup
+    const ComponentType *find(uint64_t nameHash) const
+    {
+        auto it = types.find(nameHash);
+        return it != types.end() ? &it->second : nullptr;
+    }
+
+    const ComponentType *find(std::string_view name) const
+    {
+        return find(hashTypeName(name));
+    }
+
+    // Registered types in registration order, e.g. for the editor's "Add Component" menu
+    template <typename Fn>
+    void each(Fn &&fn) const
+    {
+        for (uint64_t nameHash : order)
+        {
+            fn(types.at(nameHash));
+        }
+    }
+
+private:
+    ComponentFactory() {}
+
+    std::unordered_map<uint64_t, ComponentType> types;
+    std::vector<uint64_t> order;
+};
+
+template <typename T>
+struct ComponentRegistrar
+{
+    explicit ComponentRegistrar(const char *name)
+    {
+        ComponentFactory::getInstance().registerType<T>(name);
+    }
+};
+
+// Registers a component type with the factory during static initialization.
+// Use once per type, at namespace scope, next to the component's definition.
+#define REGISTER_COMPONENT(Type) \
+    inline const ComponentRegistrar<Type> Type##Registrar { #Type }
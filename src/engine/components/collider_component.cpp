@@ -0,0 +1,36 @@
+/**
+ * @file collider_component.cpp
+ * @brief ColliderComponent for collision shapes and events
+ */
+#include "collider_component.h"
+#include "../gameobject.h"
+#include "../component_factory.h"
+
+REGISTER_COMPONENT(ColliderComponent);
+
+void ColliderComponent::Start()
+{
+    transform = getOwner()->getTransform();
+}
+
+void ColliderComponent::serialize(json &j) const
+{
+    Component::serialize(j);
+    j["shape"] = static_cast<int>(shape);
+    j["size"] = {size.x, size.y, size.z};
+    j["isTrigger"] = isTrigger;
+    j["isStatic"] = isStatic;
+}
+
+void ColliderComponent::deserialize(const json &j)
+{
+    Component::deserialize(j);
+    shape = static_cast<CollisionShape>(j.value("shape", static_cast<int>(CollisionShape::Box)));
+    if (j.contains("size"))
+    {
+        auto sizeArray = j["size"].get<std::vector<float>>();
+        size = glm::vec3(sizeArray[0], sizeArray[1], sizeArray[2]);
+    }
+    isTrigger = j.value("isTrigger", false);
+    isStatic = j.value("isStatic", false);
+}
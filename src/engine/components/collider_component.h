@@ -1,7 +1,6 @@
 #pragma once
 #include "../component.h"
 #include "transform_component.h"
-#include <functional>
 
 enum class CollisionShape {
     Box,
@@ -16,6 +15,22 @@ struct Collision {
     float penetration;
 };
 
+class ColliderComponent;
+
+enum class CollisionPhase {
+    Enter,
+    Stay,
+    Exit
+};
+
+// Posted on the scene's event bus by whatever detects contacts, e.g. a physics system.
+// Subscribe with scene.events().subscribe<CollisionEvent>(...) and filter on collider.
+struct CollisionEvent {
+    CollisionPhase phase;
+    ColliderComponent* collider;  // The collider this event is about
+    Collision collision;          // The contact as seen from collider
+};
+
 class ColliderComponent : public Component {
 public:
     ColliderComponent() = default;
@@ -26,14 +41,7 @@ public:
     bool isTrigger = false;
     bool isStatic = false;
     
-    // Collision events
-    std::function<void(const Collision&)> onCollisionEnter;
-    std::function<void(const Collision&)> onCollisionStay;
-    std::function<void(const Collision&)> onCollisionExit;
-    
-    void start() override {
-        transform = getOwner()->getComponent<TransformComponent>();
-    }
+    void Start() override;
     
     bool checkCollision(ColliderComponent* other, Collision& outCollision) {
         if (!transform || !other || !other->transform) return false;
@@ -41,13 +49,13 @@ public:
         // Basic sphere collision check for demonstration
         if (shape == CollisionShape::Sphere && other->shape == CollisionShape::Sphere) {
             float combinedRadius = size.x + other->size.x;
-            glm::vec3 direction = other->transform->position - transform->position;
+            glm::vec3 direction = other->transform->getWorldPosition() - transform->getWorldPosition();
             float distance = glm::length(direction);
             
             if (distance < combinedRadius) {
                 outCollision.other = other->getOwner();
                 outCollision.normal = glm::normalize(direction);
-                outCollision.point = transform->position + outCollision.normal * size.x;
+                outCollision.point = transform->getWorldPosition() + outCollision.normal * size.x;
                 outCollision.penetration = combinedRadius - distance;
                 return true;
             }
@@ -57,12 +65,16 @@ public:
         return false;
     }
     
-    std::string getTypeName() const override { return "ColliderComponent"; }
+    const char *getTypeName() const override { return "ColliderComponent"; }
     
-    void onGUI() override {
+    void OnGUI() override {
         // TODO: ImGui interface for collider properties
     }
-    
+
+    // Serialization
+    void serialize(json &j) const override;
+    void deserialize(const json &j) override;
+
 private:
     TransformComponent* transform = nullptr;
 };
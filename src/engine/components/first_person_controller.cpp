@@ -0,0 +1,33 @@
+/**
+ * @file first_person_controller.cpp
+ * @brief FirstPersonController component for mouse-look and WASD movement
+ */
+#include "first_person_controller.h"
+#include "../gameobject.h"
+#include "../component_factory.h"
+
+REGISTER_COMPONENT(FirstPersonController);
+
+void FirstPersonController::Start()
+{
+    transform = getOwner()->getTransform();
+    SDL_SetRelativeMouseMode(SDL_TRUE); // Lock cursor for FPS control
+}
+
+void FirstPersonController::serialize(json &j) const
+{
+    Component::serialize(j);
+    j["moveSpeed"] = moveSpeed;
+    j["sprintMultiplier"] = sprintMultiplier;
+    j["jumpForce"] = jumpForce;
+    j["mouseSensitivity"] = mouseSensitivity;
+}
+
+void FirstPersonController::deserialize(const json &j)
+{
+    Component::deserialize(j);
+    moveSpeed = j.value("moveSpeed", moveSpeed);
+    sprintMultiplier = j.value("sprintMultiplier", sprintMultiplier);
+    jumpForce = j.value("jumpForce", jumpForce);
+    mouseSensitivity = j.value("mouseSensitivity", mouseSensitivity);
+}
@@ -19,24 +19,25 @@ public:
     float currentPitch = 0.0f;
     float currentYaw = 0.0f;
     
-    void start() override {
-        transform = getOwner()->getComponent<TransformComponent>();
-        SDL_SetRelativeMouseMode(SDL_TRUE);  // Lock cursor for FPS control
-    }
+    void Start() override;
     
-    void update(float deltaTime) override {
+    void Update(float deltaTime) override {
         if (!transform) return;
         
         handleMouseLook();
         handleMovement(deltaTime);
     }
     
-    std::string getTypeName() const override { return "FirstPersonController"; }
+    const char *getTypeName() const override { return "FirstPersonController"; }
     
-    void onGUI() override {
+    void OnGUI() override {
         // TODO: ImGui interface for controller settings
     }
 
+    // Serialization
+    void serialize(json &j) const override;
+    void deserialize(const json &j) override;
+
 private:
     TransformComponent* transform = nullptr;
     bool isSprinting = false;
@@ -52,7 +53,7 @@ private:
         // Convert Euler angles to quaternion
         glm::quat pitch = glm::angleAxis(glm::radians(currentPitch), glm::vec3(1, 0, 0));
         glm::quat yaw = glm::angleAxis(glm::radians(currentYaw), glm::vec3(0, 1, 0));
-        transform->rotation = yaw * pitch;
+        transform->setRotation(yaw * pitch);
     }
     
     void handleMovement(float deltaTime) {
@@ -72,7 +73,7 @@ private:
         // Normalize and apply movement
         if (glm::length(moveDir) > 0) {
             moveDir = glm::normalize(moveDir);
-            transform->position += moveDir * currentSpeed * deltaTime;
+            transform->translate(moveDir * currentSpeed * deltaTime);
         }
     }
 };
@@ -5,48 +5,20 @@
 #include "light.h"
 #include "../gameobject.h"
 #include "transform_component.h"
+#include "../component_factory.h"
 #include "imgui.h"
 
 // Note: Most of the Light component's functionality is implemented in the header
 // since it's primarily getters/setters and the core functionality is handled
 // in the Scene's render method. This cpp file exists mainly for proper linking.
 
+REGISTER_COMPONENT(Light);
+
 Light::Light()
     : type(Type::Directional), color(1.0f), intensity(1.0f), range(10.0f), spotAngle(45.0f)
 {
 }
 
-void Light::Render(Shader &shader)
-{
-    // TODO: Set light uniforms in shader
-    if (!enabled)
-        return;
-
-    auto transform = owner->getTransform();
-    if (!transform)
-        return;
-
-    // Set light properties in shader
-    shader.setVec3("lightColor", color);
-    shader.setFloat("lightIntensity", intensity);
-
-    if (type == Type::Directional)
-    {
-        shader.setVec3("lightDir", getDirection());
-    }
-    else
-    {
-        shader.setVec3("lightPos", getPosition());
-        shader.setFloat("lightRange", range);
-
-        if (type == Type::Spot)
-        {
-            shader.setFloat("spotAngle", glm::radians(spotAngle));
-            shader.setVec3("spotDir", getDirection());
-        }
-    }
-}
-
 void Light::OnGUI()
 {
     if (ImGui::TreeNode("Light"))
@@ -101,7 +73,7 @@ glm::vec3 Light::getDirection() const
     if (auto transform = owner->getTransform())
     {
         // Use the forward vector of the transform
-        glm::mat4 rotation = transform->getLocalMatrix();
+        const glm::mat4 &rotation = transform->getWorldMatrix();
         return -glm::normalize(glm::vec3(rotation[2])); // -Z is forward
     }
     return glm::vec3(0.0f, -1.0f, 0.0f); // Default to pointing down
@@ -111,7 +83,7 @@ glm::vec3 Light::getPosition() const
 {
     if (auto transform = owner->getTransform())
     {
-        return transform->position;
+        return transform->getWorldPosition();
     }
     return glm::vec3(0.0f);
 }
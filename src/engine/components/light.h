@@ -16,7 +16,6 @@ public:
     virtual ~Light() = default;
 
     // Core functionality
-    virtual void Render(Shader &shader) override;
     virtual void OnGUI() override;
 
     // Properties
@@ -35,7 +34,7 @@ public:
     virtual void serialize(json &j) const override;
     virtual void deserialize(const json &j) override;
 
-    virtual std::string getTypeName() const override
+    virtual const char *getTypeName() const override
     {
         return "Light";
     }
@@ -5,29 +5,20 @@
 #include "meshrenderer.h"
 #include "../gameobject.h"
 #include "../resourcemanager.h"
+#include "../component_factory.h"
 #include "imgui.h"
 
 // Note: Most of the MeshRenderer component's functionality is implemented in the header
 // since it's primarily getters/setters and the core functionality is handled
 // in the render method. This cpp file exists mainly for proper linking.
 
+REGISTER_COMPONENT(MeshRenderer);
+
 MeshRenderer::MeshRenderer()
-    : mesh(nullptr), color(0.7f, 0.2f, 0.2f), wireframe(false)
+    : mesh(nullptr), color(0.7f, 0.2f, 0.2f), wireframe(false), occluder(false)
 {
 }
 
-void MeshRenderer::Render(Shader &shader)
-{
-    if (!enabled || !mesh)
-        return;
-
-    // Set material properties
-    shader.setVec3("objectColor", color);
-
-    // Render mesh
-    mesh->Draw();
-}
-
 void MeshRenderer::OnGUI()
 {
     if (ImGui::TreeNode("Mesh Renderer"))
@@ -48,13 +39,13 @@ void MeshRenderer::OnGUI()
             switch (currentMesh)
             {
             case 0:
-                mesh = nullptr;
+                setMesh(nullptr);
                 break;
             case 1:
-                mesh = Resources().getMesh("Cube");
+                setMesh(Resources().getMesh("Cube"));
                 break;
             case 2:
-                mesh = Resources().getMesh("Sphere");
+                setMesh(Resources().getMesh("Sphere"));
                 break;
             }
         }
@@ -65,6 +56,9 @@ void MeshRenderer::OnGUI()
         // Wireframe mode
         ImGui::Checkbox("Wireframe", &wireframe);
 
+        // Walls and other large opaque meshes that hide what's behind them
+        ImGui::Checkbox("Occluder", &occluder);
+
         ImGui::TreePop();
     }
 }
@@ -87,6 +81,7 @@ void MeshRenderer::serialize(json &j) const
     // Save color
     j["color"] = {color.r, color.g, color.b};
     j["wireframe"] = wireframe;
+    j["occluder"] = occluder;
 }
 
 void MeshRenderer::deserialize(const json &j)
@@ -96,14 +91,15 @@ void MeshRenderer::deserialize(const json &j)
     // Load mesh type
     std::string meshType = j["meshType"].get<std::string>();
     if (meshType == "None")
-        mesh = nullptr;
+        setMesh(nullptr);
     else if (meshType == "Cube")
-        mesh = Resources().getMesh("Cube");
+        setMesh(Resources().getMesh("Cube"));
     else if (meshType == "Sphere")
-        mesh = Resources().getMesh("Sphere");
+        setMesh(Resources().getMesh("Sphere"));
 
     // Load color
     auto colorArray = j["color"].get<std::vector<float>>();
     color = glm::vec3(colorArray[0], colorArray[1], colorArray[2]);
     wireframe = j["wireframe"].get<bool>();
+    occluder = j.value("occluder", false);
 }
@@ -7,6 +7,8 @@
 #include "../../renderer/mesh.h"
 #include "../resourcemanager.h"
 #include <glm/glm.hpp>
+#include <atomic>
+#include <cstdint>
 #include <memory>
 
 class MeshRenderer : public Component
@@ -16,28 +18,42 @@ public:
     virtual ~MeshRenderer() = default;
 
     // Core functionality
-    virtual void Render(Shader &shader) override;
     virtual void OnGUI() override;
 
     // Mesh management
-    void setMesh(std::shared_ptr<Mesh> newMesh) { mesh = newMesh; }
+    void setMesh(std::shared_ptr<Mesh> newMesh)
+    {
+        mesh = std::move(newMesh);
+        meshChanges.fetch_add(1, std::memory_order_relaxed);
+    }
     std::shared_ptr<Mesh> getMesh() const { return mesh; }
+    const Mesh *getMeshPtr() const { return mesh.get(); } // No refcount traffic, for per-frame use
+
+    // Bumped whenever any renderer's mesh is set, so bounds caches know to look again
+    static uint32_t getMeshChangeCount() { return meshChanges.load(std::memory_order_relaxed); }
 
     // Material properties
     void setColor(const glm::vec3 &newColor) { color = newColor; }
     const glm::vec3 &getColor() const { return color; }
 
+    // Occluders are rasterized into the scene's occlusion buffer to hide what's behind them
+    void setOccluder(bool isOccluder) { occluder = isOccluder; }
+    bool isOccluder() const { return occluder; }
+
     // Serialization
     virtual void serialize(json &j) const override;
     virtual void deserialize(const json &j) override;
 
-    virtual std::string getTypeName() const override
+    virtual const char *getTypeName() const override
     {
         return "MeshRenderer";
     }
 
 private:
+    static inline std::atomic<uint32_t> meshChanges{0};
+
     std::shared_ptr<Mesh> mesh;
     glm::vec3 color;
     bool wireframe;
+    bool occluder;
 };
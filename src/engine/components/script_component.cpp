@@ -2,10 +2,13 @@
 #include "script_component.h"
 #include "../scripting/lua_context.h"
 #include "../components/transform_component.h"
+#include "../component_factory.h"
 #include "../../helpers/logging.h"
 #include <memory>
 #include <fstream>
 
+REGISTER_COMPONENT(ScriptComponent);
+
 ScriptComponent::ScriptComponent() = default;
 ScriptComponent::~ScriptComponent() = default;
 
@@ -18,7 +18,7 @@ public:
     void Start() override;
 
     // Required override from Component base class
-    std::string getTypeName() const override { return "ScriptComponent"; }
+    const char *getTypeName() const override { return "ScriptComponent"; }
 
     // Serialization
     void serialize(json &j) const override;
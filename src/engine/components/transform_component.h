@@ -1,5 +1,7 @@
 #pragma once
 #include "../component.h"
+#include "../component_factory.h"
+#include "../math/transform_kernel.h"
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
 #include <glm/gtx/quaternion.hpp>
@@ -16,35 +18,99 @@ public:
     TransformComponent() : position(0.0f),
                            rotation(1.0f, 0.0f, 0.0f, 0.0f), // Identity quaternion
                            scale(1.0f),
-                           gizmoOperation(ImGuizmo::TRANSLATE)
+                           worldMatrix(1.0f),
+                           normalMatrix(1.0f),
+                           version(0),
+                           worldVersion(0)
     {
     }
 
-    // Core transform properties
-    glm::vec3 position;
-    glm::quat rotation;
-    glm::vec3 scale;
+    // Core transform properties. Go through the setters so the change is seen: each one
+    // bumps the version.
+    const glm::vec3 &getPosition() const { return position; }
+    const glm::quat &getRotation() const { return rotation; }
+    const glm::vec3 &getScale() const { return scale; }
+
+    void setPosition(const glm::vec3 &newPosition)
+    {
+        position = newPosition;
+        markChanged();
+    }
+
+    void setRotation(const glm::quat &newRotation)
+    {
+        rotation = newRotation;
+        markChanged();
+    }
+
+    void setScale(const glm::vec3 &newScale)
+    {
+        scale = newScale;
+        markChanged();
+    }
+
+    // Sets all three at once, as a single change
+    void setLocal(const glm::vec3 &newPosition, const glm::quat &newRotation, const glm::vec3 &newScale)
+    {
+        position = newPosition;
+        rotation = newRotation;
+        scale = newScale;
+        markChanged();
+    }
+
+    void translate(const glm::vec3 &offset)
+    {
+        setPosition(position + offset);
+    }
 
     // Local space vectors
     glm::vec3 forward() const { return glm::rotate(rotation, glm::vec3(0.0f, 0.0f, -1.0f)); }
     glm::vec3 right() const { return glm::rotate(rotation, glm::vec3(1.0f, 0.0f, 0.0f)); }
     glm::vec3 up() const { return glm::rotate(rotation, glm::vec3(0.0f, 1.0f, 0.0f)); }
 
-    // Transform matrices
+    // translate * rotate * scale. The scene builds these in SIMD batches for every transform
+    // that changed (see TransformHierarchy); this is for one-off use outside that pass.
     glm::mat4 getLocalMatrix() const
     {
-        glm::mat4 transform = glm::mat4(1.0f);
-        transform = glm::translate(transform, position);
-        transform = transform * glm::toMat4(rotation);
-        transform = glm::scale(transform, scale);
-        return transform;
+        return composeTransform(position, rotation, scale);
+    }
+
+    // Parent's world matrix * local matrix, refreshed by the scene's TransformHierarchy
+    // once per frame (Scene::updateWorldTransforms)
+    const glm::mat4 &getWorldMatrix() const
+    {
+        return worldMatrix;
+    }
+
+    // inverse(transpose(mat3(world))), for transforming normals; refreshed with the world matrix
+    const glm::mat3 &getNormalMatrix() const
+    {
+        return normalMatrix;
+    }
+
+    glm::vec3 getWorldPosition() const
+    {
+        return glm::vec3(worldMatrix[3]);
+    }
+
+    // Bumped on every change. Systems can remember the version they last saw and skip
+    // transforms that haven't moved since, e.g. static level geometry.
+    uint32_t getVersion() const
+    {
+        return version;
+    }
+
+    // Bumped each time the world matrix is rewritten, which also happens when only a parent moved
+    uint32_t getWorldVersion() const
+    {
+        return worldVersion;
     }
 
     // Utility functions
     void setEulerAngles(const glm::vec3 &eulerDegrees)
     {
         glm::vec3 eulerRadians = glm::radians(eulerDegrees);
-        rotation = glm::quat(eulerRadians);
+        setRotation(glm::quat(eulerRadians));
     }
 
     glm::vec3 getEulerAngles() const
@@ -55,14 +121,10 @@ public:
     void lookAt(const glm::vec3 &target)
     {
         glm::vec3 direction = glm::normalize(target - position);
-        rotation = glm::quatLookAt(direction, glm::vec3(0.0f, 1.0f, 0.0f));
+        setRotation(glm::quatLookAt(direction, glm::vec3(0.0f, 1.0f, 0.0f)));
     }
 
-    // Gizmo operations
-    ImGuizmo::OPERATION getGizmoOperation() const { return gizmoOperation; }
-    void setGizmoOperation(ImGuizmo::OPERATION op) { gizmoOperation = op; }
-
-    std::string getTypeName() const override { return "TransformComponent"; }
+    const char *getTypeName() const override { return "TransformComponent"; }
 
     // Serialization
     void serialize(nlohmann::json &j) const override
@@ -93,6 +155,8 @@ public:
         scale.x = j["scale"]["x"];
         scale.y = j["scale"]["y"];
         scale.z = j["scale"]["z"];
+
+        markChanged();
     }
 
     void OnGUI() override
@@ -103,7 +167,7 @@ public:
             glm::vec3 pos = position;
             if (ImGui::DragFloat3("Position", glm::value_ptr(pos), 0.1f))
             {
-                position = pos;
+                setPosition(pos);
             }
 
             // Rotation (as Euler angles for easier editing)
@@ -117,37 +181,22 @@ public:
             glm::vec3 scl = scale;
             if (ImGui::DragFloat3("Scale", glm::value_ptr(scl), 0.1f))
             {
-                scale = scl;
+                setScale(scl);
             }
-
-            ImGui::Separator();
-            ImGui::Text("Gizmo Mode:");
-
-            // Gizmo operation radio buttons
-            bool isTranslate = gizmoOperation == ImGuizmo::TRANSLATE;
-            bool isRotate = gizmoOperation == ImGuizmo::ROTATE;
-            bool isScale = gizmoOperation == ImGuizmo::SCALE;
-
-            if (ImGui::RadioButton("Translate", &isTranslate))
-                gizmoOperation = ImGuizmo::TRANSLATE;
-            ImGui::SameLine();
-            if (ImGui::RadioButton("Rotate", &isRotate))
-                gizmoOperation = ImGuizmo::ROTATE;
-            ImGui::SameLine();
-            if (ImGui::RadioButton("Scale", &isScale))
-                gizmoOperation = ImGuizmo::SCALE;
         }
     }
 
-    void manipulateTransform(const glm::mat4 &view, const glm::mat4 &proj)
+    // The gizmo works in world space; parentWorld converts the result back to local space
+    void manipulateTransform(const glm::mat4 &view, const glm::mat4 &proj, ImGuizmo::OPERATION operation,
+                             const glm::mat4 &parentWorld = glm::mat4(1.0f))
     {
-        glm::mat4 transform = getLocalMatrix();
+        glm::mat4 transform = worldMatrix;
 
         // Manipulate transform with ImGuizmo
         if (ImGuizmo::Manipulate(
                 glm::value_ptr(view),
                 glm::value_ptr(proj),
-                gizmoOperation,
+                operation,
                 ImGuizmo::LOCAL,
                 glm::value_ptr(transform)))
         {
@@ -158,15 +207,32 @@ public:
             glm::quat newRotation;
             glm::vec3 newScale;
 
+            worldMatrix = transform;
+            transform = glm::inverse(parentWorld) * transform;
             if (glm::decompose(transform, newScale, newRotation, newPosition, skew, perspective))
             {
-                position = newPosition;
-                rotation = glm::normalize(newRotation); // Ensure unit quaternion
-                scale = newScale;
+                setLocal(newPosition, glm::normalize(newRotation), newScale); // Ensure unit quaternion
             }
         }
     }
 
 private:
-    ImGuizmo::OPERATION gizmoOperation;
+    friend class TransformHierarchy;
+
+    void markChanged()
+    {
+        ++version;
+    }
+
+    // Editor-only state (gizmo mode etc.) lives in the Editor so this stays a compact,
+    // hot struct in its pool
+    glm::vec3 position;
+    glm::quat rotation;
+    glm::vec3 scale;
+    glm::mat4 worldMatrix;
+    glm::mat3 normalMatrix;
+    uint32_t version;
+    uint32_t worldVersion;
 };
+
+REGISTER_COMPONENT(TransformComponent);
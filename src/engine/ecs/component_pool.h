@@ -0,0 +1,166 @@
+/**
+ * @file component_pool.h
+ * @brief Contiguous per-type storage for components
+ */
+#pragma once
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include "entity.h"
+#include "slab_pool.h"
+
+class Component;
+
+/**
+ * @brief Type-erased interface so the registry can manage pools of any component type.
+ */
+class IComponentPool
+{
+public:
+    virtual ~IComponentPool() = default;
+
+    virtual Component *get(Entity entity) = 0;
+    virtual void remove(Entity entity) = 0;
+    virtual void clear() = 0;
+    virtual size_t size() const = 0;
+
+    // A component was enabled or disabled, or its object activated or deactivated
+    void markActiveDirty() { activeDirty = true; }
+
+    // Changes whenever active() rebuilds its list, so callers can tell the set changed
+    uint64_t getActiveVersion() const { return activeVersion; }
+
+protected:
+    bool activeDirty = true;
+    uint64_t activeVersion = 0;
+};
+
+/**
+ * @brief Sparse set of components of a single type.
+ *
+ * Components are constructed in place inside the pages of a SlabPool, so every instance
+ * of a type sits next to the others in memory and iterating a pool is a linear walk.
+ * Pages are never moved, which keeps the Component pointers handed out by GameObject
+ * stable for as long as the component exists.
+ */
+template <typename T>
+class ComponentPool : public IComponentPool
+{
+public:
+    ComponentPool() = default;
+    ~ComponentPool() override { clear(); }
+
+    ComponentPool(const ComponentPool &) = delete;
+    ComponentPool &operator=(const ComponentPool &) = delete;
+
+    template <typename... Args>
+    T *emplace(Entity entity, Args &&...args)
+    {
+        if (T *existing = tryGet(entity))
+        {
+            return existing;
+        }
+
+        uint32_t slot = storage.create(std::forward<Args>(args)...);
+        if (slot >= slotOwners.size())
+        {
+            slotOwners.resize(slot + 1, NullEntity);
+        }
+        if (entity >= sparse.size())
+        {
+            sparse.resize(entity + 1, NullSlot);
+        }
+        sparse[entity] = slot;
+        slotOwners[slot] = entity;
+        activeDirty = true;
+
+        T *component = storage.at(slot);
+        component->setPool(this);
+        return component;
+    }
+
+    bool contains(Entity entity) const
+    {
+        return entity < sparse.size() && sparse[entity] != NullSlot;
+    }
+
+    T *tryGet(Entity entity)
+    {
+        return contains(entity) ? storage.at(sparse[entity]) : nullptr;
+    }
+
+    Component *get(Entity entity) override
+    {
+        return tryGet(entity);
+    }
+
+    void remove(Entity entity) override
+    {
+        if (!contains(entity))
+            return;
+
+        uint32_t slot = sparse[entity];
+        storage.destroy(slot);
+        slotOwners[slot] = NullEntity;
+        sparse[entity] = NullSlot;
+        activeDirty = true;
+    }
+
+    // Destroys every component in one pass; the pages stay allocated for reuse
+    void clear() override
+    {
+        storage.clear();
+        sparse.clear();
+        slotOwners.clear();
+        activeList.clear();
+        activeDirty = true;
+    }
+
+    size_t size() const override { return storage.size(); }
+
+    /**
+     * @brief Visit every live component in storage order.
+     * @param fn Callable taking (Entity, T&).
+     */
+    template <typename Fn>
+    void each(Fn &&fn)
+    {
+        storage.each([this, &fn](uint32_t slot, T &component)
+        {
+            fn(slotOwners[slot], component);
+        });
+    }
+
+    /**
+     * @brief The components that are running (enabled, on an active object), in storage order.
+     *
+     * Rebuilt on first use after a component is added, removed or toggled, so per-frame
+     * hook dispatch never looks at disabled components. Go through
+     * EntityRegistry::active() when several threads may ask at once.
+     */
+    const std::vector<T *> &active()
+    {
+        if (activeDirty)
+        {
+            activeList.clear();
+            storage.each([this](uint32_t, T &component)
+            {
+                if (component.isRunning())
+                {
+                    activeList.push_back(&component);
+                }
+            });
+            activeDirty = false;
+            ++activeVersion;
+        }
+        return activeList;
+    }
+
+private:
+    static constexpr uint32_t NullSlot = SlabPool<T>::NullSlot;
+
+    SlabPool<T> storage;
+    std::vector<uint32_t> sparse;   // Entity -> slot
+    std::vector<Entity> slotOwners; // Slot -> entity, NullEntity when the slot is free
+    std::vector<T *> activeList;
+};
@@ -0,0 +1,54 @@
+/**
+ * @file component_type.h
+ * @brief Compact numeric ids and hashed names for component types
+ */
+#pragma once
+#include <atomic>
+#include <bitset>
+#include <cassert>
+#include <cstdint>
+#include <string_view>
+
+using ComponentTypeId = uint32_t;
+
+// Upper bound on distinct component types, one bit each in an entity's mask
+constexpr ComponentTypeId MaxComponentTypes = 64;
+
+using ComponentMask = std::bitset<MaxComponentTypes>;
+
+/**
+ * @brief FNV-1a hash of a type name, usable at compile time.
+ */
+constexpr uint64_t hashTypeName(std::string_view name)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (char c : name)
+    {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+namespace detail
+{
+    inline ComponentTypeId nextComponentTypeId()
+    {
+        static std::atomic<ComponentTypeId> counter{0};
+        return counter.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Dense id for a component type, assigned the first time the type is used.
+ *
+ * Ids index the registry's pool table and the per-entity component masks directly,
+ * so checking whether an entity has a component is a single bit test.
+ */
+template <typename T>
+ComponentTypeId componentTypeId()
+{
+    static const ComponentTypeId id = detail::nextComponentTypeId();
+    assert(id < MaxComponentTypes && "Too many component types, raise MaxComponentTypes");
+    return id;
+}
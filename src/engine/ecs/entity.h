@@ -0,0 +1,11 @@
+/**
+ * @file entity.h
+ * @brief Entity identifiers used by the component storage
+ */
+#pragma once
+#include <cstdint>
+
+// An entity is just a slot index into the registry's component pools
+using Entity = uint32_t;
+
+constexpr Entity NullEntity = UINT32_MAX;
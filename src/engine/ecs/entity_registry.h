@@ -0,0 +1,266 @@
+/**
+ * @file entity_registry.h
+ * @brief Owns all entities and the per-type component pools of a scene
+ */
+#pragma once
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "entity.h"
+#include "component_pool.h"
+#include "component_type.h"
+#include "view.h"
+
+class EntityRegistry
+{
+public:
+    // The pool table never grows, so creating a pool can't move one another thread is using
+    EntityRegistry() : pools(MaxComponentTypes), versions(MaxComponentTypes, 0) {}
+    ~EntityRegistry() { clear(); }
+
+    EntityRegistry(const EntityRegistry &) = delete;
+    EntityRegistry &operator=(const EntityRegistry &) = delete;
+
+    // Entity management
+    Entity create()
+    {
+        if (!freeEntities.empty())
+        {
+            Entity entity = freeEntities.back();
+            freeEntities.pop_back();
+            alive[entity] = true;
+            return entity;
+        }
+
+        alive.push_back(true);
+        masks.emplace_back();
+        return static_cast<Entity>(alive.size() - 1);
+    }
+
+    void destroy(Entity entity)
+    {
+        if (!valid(entity))
+            return;
+
+        removeAll(entity);
+        alive[entity] = false;
+        freeEntities.push_back(entity);
+    }
+
+    bool valid(Entity entity) const
+    {
+        return entity < alive.size() && alive[entity];
+    }
+
+    // Component management
+    template <typename T, typename... Args>
+    T *emplace(Entity entity, Args &&...args)
+    {
+        T *component = pool<T>().emplace(entity, std::forward<Args>(args)...);
+        masks[entity].set(componentTypeId<T>());
+        touch(componentTypeId<T>());
+        return component;
+    }
+
+    template <typename T>
+    bool has(Entity entity) const
+    {
+        return entity < masks.size() && masks[entity].test(componentTypeId<T>());
+    }
+
+    ComponentMask getMask(Entity entity) const
+    {
+        return entity < masks.size() ? masks[entity] : ComponentMask();
+    }
+
+    template <typename T>
+    T *tryGet(Entity entity)
+    {
+        if (!has<T>(entity))
+            return nullptr;
+        return static_cast<ComponentPool<T> *>(pools[componentTypeId<T>()].get())->tryGet(entity);
+    }
+
+    // Type-erased lookup for callers that only know the type id (e.g. deserialization)
+    Component *tryGet(ComponentTypeId type, Entity entity)
+    {
+        if (entity >= masks.size() || !masks[entity].test(type))
+            return nullptr;
+        return pools[type]->get(entity);
+    }
+
+    template <typename T>
+    void remove(Entity entity)
+    {
+        if (!has<T>(entity))
+            return;
+        pool<T>().remove(entity);
+        masks[entity].reset(componentTypeId<T>());
+        touch(componentTypeId<T>());
+    }
+
+    void removeAll(Entity entity)
+    {
+        if (entity >= masks.size())
+            return;
+
+        // Only visit the pools this entity actually has a component in
+        ComponentMask &mask = masks[entity];
+        for (ComponentTypeId type = 0; mask.any() && type < pools.size(); ++type)
+        {
+            if (mask.test(type))
+            {
+                pools[type]->remove(entity);
+                mask.reset(type);
+                touch(type);
+            }
+        }
+    }
+
+    template <typename T>
+    ComponentPool<T> &pool()
+    {
+        ComponentTypeId type = componentTypeId<T>();
+        if (!pools[type])
+        {
+            pools[type] = std::make_unique<ComponentPool<T>>();
+        }
+        return *static_cast<ComponentPool<T> *>(pools[type].get());
+    }
+
+    /**
+     * @brief The running (enabled, on an active object) components of type T.
+     *
+     * Same threading rules as view(): toggling a component or its object while systems
+     * run invalidates the list, so do that from the main thread or through commands.
+     */
+    template <typename T>
+    const std::vector<T *> &active()
+    {
+        std::lock_guard<std::mutex> lock(queryMutex);
+        return pool<T>().active();
+    }
+
+    // Version of the list active<T>() last returned, see IComponentPool::getActiveVersion
+    template <typename T>
+    uint64_t activeVersion()
+    {
+        std::lock_guard<std::mutex> lock(queryMutex);
+        return pool<T>().getActiveVersion();
+    }
+
+    /**
+     * @brief Entities that have all of Ts, e.g. view<TransformComponent, MeshRenderer>().
+     *
+     * The matching entity list is cached per type combination and only rebuilt when a
+     * component of one of those types has been added or removed since the last call.
+     * Safe to call from several systems at once as long as none of them adds or removes
+     * components while they run.
+     */
+    template <typename... Ts>
+    View<Ts...> view()
+    {
+        static_assert(sizeof...(Ts) > 0, "A view needs at least one component type");
+
+        ComponentMask required;
+        (required.set(componentTypeId<Ts>()), ...);
+
+        // Versions only ever grow, so the sum changes whenever any of them does
+        uint64_t stamp = (version(componentTypeId<Ts>()) + ...);
+
+        std::lock_guard<std::mutex> lock(queryMutex);
+        Query &query = queries[required];
+        if (!query.built || query.stamp != stamp)
+        {
+            rebuildQuery<Ts...>(query, required);
+            query.stamp = stamp;
+            query.built = true;
+        }
+
+        return View<Ts...>(query.entities, pool<Ts>()...);
+    }
+
+    /**
+     * @brief Visit every component of type T in storage order.
+     * @param fn Callable taking (Entity, T&).
+     */
+    template <typename T, typename Fn>
+    void each(Fn &&fn)
+    {
+        pool<T>().each(std::forward<Fn>(fn));
+    }
+
+    void clear()
+    {
+        for (auto &componentPool : pools)
+        {
+            if (componentPool)
+            {
+                componentPool->clear();
+            }
+        }
+        for (uint64_t &typeVersion : versions)
+        {
+            ++typeVersion;
+        }
+        alive.clear();
+        masks.clear();
+        freeEntities.clear();
+    }
+
+private:
+    struct Query
+    {
+        std::vector<Entity> entities;
+        uint64_t stamp = 0;
+        bool built = false;
+    };
+
+    // Structural changes to a type bump its version, which invalidates cached views
+    void touch(ComponentTypeId type)
+    {
+        ++versions[type];
+    }
+
+    uint64_t version(ComponentTypeId type) const
+    {
+        return versions[type];
+    }
+
+    template <typename... Ts>
+    void rebuildQuery(Query &query, const ComponentMask &required)
+    {
+        query.entities.clear();
+
+        // Walk the smallest pool and keep the entities that have the rest as well
+        IComponentPool *smallest = nullptr;
+        ((smallest = (!smallest || pool<Ts>().size() < smallest->size()) ? &pool<Ts>() : smallest), ...);
+
+        (visitIfSmallest<Ts>(smallest, query, required), ...);
+    }
+
+    template <typename T>
+    void visitIfSmallest(IComponentPool *smallest, Query &query, const ComponentMask &required)
+    {
+        if (smallest != &pool<T>())
+            return;
+
+        pool<T>().each([&](Entity entity, T &)
+        {
+            if ((masks[entity] & required) == required)
+            {
+                query.entities.push_back(entity);
+            }
+        });
+    }
+
+    std::vector<std::unique_ptr<IComponentPool>> pools; // Indexed by ComponentTypeId
+    std::vector<uint64_t> versions;                      // Indexed by ComponentTypeId
+    std::unordered_map<ComponentMask, Query> queries;
+    std::mutex queryMutex;                               // Guards queries during parallel updates
+    std::vector<ComponentMask> masks;                    // Indexed by Entity
+    std::vector<bool> alive;
+    std::vector<Entity> freeEntities;
+};
@@ -0,0 +1,164 @@
+/**
+ * @file slab_pool.h
+ * @brief Paged object pool with slot recycling and bulk release
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Fixed-size pages of T, addressed by slot index.
+ *
+ * Objects are constructed in place and never move, so pointers stay valid until the
+ * object is destroyed. Destroyed slots go on a free list and are reused by the next
+ * create(), so steady spawn/despawn churn never touches the general-purpose heap once
+ * enough pages exist. clear() destroys every live object in one linear pass and keeps
+ * the pages around for the next batch; releaseMemory() hands them back to the heap.
+ */
+template <typename T>
+class SlabPool
+{
+public:
+    static constexpr size_t PageSize = 256;
+    static constexpr uint32_t NullSlot = UINT32_MAX;
+
+    SlabPool() = default;
+    ~SlabPool() { clear(); }
+
+    SlabPool(const SlabPool &) = delete;
+    SlabPool &operator=(const SlabPool &) = delete;
+
+    template <typename... Args>
+    uint32_t create(Args &&...args)
+    {
+        uint32_t slot = allocateSlot();
+        new (address(slot)) T(std::forward<Args>(args)...);
+        live[slot] = true;
+        ++count;
+        return slot;
+    }
+
+    void destroy(uint32_t slot)
+    {
+        if (!occupied(slot))
+            return;
+
+        at(slot)->~T();
+        live[slot] = false;
+        freeSlots.push_back(slot);
+        --count;
+    }
+
+    bool occupied(uint32_t slot) const
+    {
+        return slot < live.size() && live[slot];
+    }
+
+    T *at(uint32_t slot)
+    {
+        return std::launder(reinterpret_cast<T *>(address(slot)));
+    }
+
+    /**
+     * @brief Find the slot an object lives in, or NullSlot if it isn't from this pool.
+     */
+    uint32_t slotOf(const T *object) const
+    {
+        const unsigned char *bytes = reinterpret_cast<const unsigned char *>(object);
+        std::less<const unsigned char *> before;
+        for (size_t page = 0; page < pages.size(); ++page)
+        {
+            const unsigned char *begin = pages[page]->bytes;
+            if (!before(bytes, begin) && before(bytes, begin + sizeof(Page::bytes)))
+            {
+                return static_cast<uint32_t>(page * PageSize + (bytes - begin) / sizeof(T));
+            }
+        }
+        return NullSlot;
+    }
+
+    // Number of slots ever handed out; every live slot is below this
+    uint32_t capacity() const { return static_cast<uint32_t>(live.size()); }
+    size_t size() const { return count; }
+
+    /**
+     * @brief Visit every live object in memory order.
+     * @param fn Callable taking (uint32_t slot, T&).
+     */
+    template <typename Fn>
+    void each(Fn &&fn)
+    {
+        for (uint32_t slot = 0; slot < live.size(); ++slot)
+        {
+            if (live[slot])
+            {
+                fn(slot, *at(slot));
+            }
+        }
+    }
+
+    void clear()
+    {
+        if constexpr (!std::is_trivially_destructible<T>::value)
+        {
+            for (uint32_t slot = 0; slot < live.size(); ++slot)
+            {
+                if (live[slot])
+                {
+                    at(slot)->~T();
+                }
+            }
+        }
+        live.clear();
+        freeSlots.clear();
+        count = 0;
+    }
+
+    void releaseMemory()
+    {
+        clear();
+        pages.clear();
+        pages.shrink_to_fit();
+    }
+
+private:
+    struct Page
+    {
+        alignas(T) unsigned char bytes[sizeof(T) * PageSize];
+    };
+
+    void *address(uint32_t slot)
+    {
+        return pages[slot / PageSize]->bytes + sizeof(T) * (slot % PageSize);
+    }
+
+    uint32_t allocateSlot()
+    {
+        if (!freeSlots.empty())
+        {
+            uint32_t slot = freeSlots.back();
+            freeSlots.pop_back();
+            return slot;
+        }
+
+        // Pages kept from an earlier clear() are reused before allocating new ones
+        uint32_t slot = static_cast<uint32_t>(live.size());
+        if (slot / PageSize >= pages.size())
+        {
+            pages.push_back(std::make_unique<Page>());
+        }
+        live.push_back(false);
+        return slot;
+    }
+
+    std::vector<std::unique_ptr<Page>> pages;
+    std::vector<bool> live;          // Slot -> holds a constructed object
+    std::vector<uint32_t> freeSlots; // Destroyed slots available for reuse
+    size_t count = 0;
+};
@@ -0,0 +1,50 @@
+/**
+ * @file view.h
+ * @brief Iteration over the entities that have every one of a set of component types
+ */
+#pragma once
+#include <tuple>
+#include <vector>
+#include "entity.h"
+#include "component_pool.h"
+
+/**
+ * @brief Result of EntityRegistry::view<Ts...>().
+ *
+ * Holds the registry's cached list of matching entities, in the storage order of the
+ * smallest pool involved, plus direct pointers to each pool. Iterating never probes
+ * entities that lack one of the types. Adding or removing components of the viewed
+ * types while iterating invalidates the view.
+ */
+template <typename... Ts>
+class View
+{
+public:
+    View(const std::vector<Entity> &entities, ComponentPool<Ts> &...pools)
+        : entities(&entities), pools(&pools...)
+    {
+    }
+
+    /**
+     * @brief Visit every matching entity.
+     * @param fn Callable taking (Entity, Ts&...).
+     */
+    template <typename Fn>
+    void each(Fn &&fn) const
+    {
+        for (Entity entity : *entities)
+        {
+            fn(entity, *std::get<ComponentPool<Ts> *>(pools)->tryGet(entity)...);
+        }
+    }
+
+    std::vector<Entity>::const_iterator begin() const { return entities->begin(); }
+    std::vector<Entity>::const_iterator end() const { return entities->end(); }
+
+    size_t size() const { return entities->size(); }
+    bool empty() const { return entities->empty(); }
+
+private:
+    const std::vector<Entity> *entities;
+    std::tuple<ComponentPool<Ts> *...> pools;
+};
@@ -9,6 +9,8 @@
 #include <unordered_map>
 
 #include "scene.h"
+#include "scene_snapshot.h"
+#include "world_partition.h"
 #include "gameobject.h"
 #include "../version.h"
 #include "components/light.h"
@@ -18,19 +20,24 @@
 
 #include <imgui.h>
 #include <imgui_stdlib.h>
+#include "ImGuizmo/ImGuizmo.h"
 
 class Editor
 {
 public:
-    Editor() : activeScene(nullptr), selectedObject(nullptr), isPlaying(false) {}
+    Editor() : activeScene(nullptr), isPlaying(false), gizmoOperation(ImGuizmo::TRANSLATE) {}
 
     void setActiveScene(Scene *scene)
     {
         activeScene = scene;
-        selectedObject = nullptr;
+        selectedHandle = {};
     }
 
-    GameObject *getSelectedObject() const { return selectedObject; }
+    // Null if nothing is selected or the selected object has since been removed
+    GameObject *getSelectedObject() const
+    {
+        return activeScene ? activeScene->resolve(selectedHandle) : nullptr;
+    }
 
     void update()
     {
@@ -41,6 +48,16 @@ public:
         renderSceneHierarchy();
         renderInspector();
         renderToolbar();
+        renderGizmo();
+
+        // Apply the changes the panels recorded while walking the scene
+        activeScene->dispatchEvents();
+        activeScene->flushCommands();
+
+        if (isPlaying)
+        {
+            activeScene->update(ImGui::GetIO().DeltaTime);
+        }
     }
 
 private:
@@ -62,6 +79,10 @@ private:
                 {
                     ImGui::OpenPopup("LoadScene");
                 }
+                if (ImGui::MenuItem("Save World"))
+                {
+                    ImGui::OpenPopup("SaveWorld");
+                }
                 ImGui::EndMenu();
             }
 
@@ -121,6 +142,30 @@ private:
             ImGui::EndPopup();
         }
 
+        // Save World Dialog: the scene split into streamable cells
+        if (ImGui::BeginPopupModal("SaveWorld", nullptr, ImGuiWindowFlags_AlwaysAutoResize))
+        {
+            static char pathBuffer[256] = "world";
+            static float cellSize = 64.0f;
+            ImGui::InputText("Directory", pathBuffer, sizeof(pathBuffer));
+            ImGui::DragFloat("Cell Size", &cellSize, 1.0f, 1.0f, 10000.0f);
+
+            if (ImGui::Button("Save"))
+            {
+                if (activeScene)
+                {
+                    WorldPartition::save(*activeScene, pathBuffer, cellSize);
+                }
+                ImGui::CloseCurrentPopup();
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Cancel"))
+            {
+                ImGui::CloseCurrentPopup();
+            }
+            ImGui::EndPopup();
+        }
+
         // Load Scene Dialog
         if (ImGui::BeginPopupModal("LoadScene", nullptr, ImGuiWindowFlags_AlwaysAutoResize))
         {
@@ -149,9 +194,13 @@ private:
 
         if (activeScene)
         {
-            for (const auto &gameObject : activeScene->getAllGameObjects())
+            // Roots only; children are drawn inside their parent's node
+            for (GameObject *gameObject : activeScene->getAllGameObjects())
             {
-                renderGameObjectNode(gameObject.get());
+                if (!gameObject->getParent())
+                {
+                    renderGameObjectNode(gameObject);
+                }
             }
         }
 
@@ -162,7 +211,12 @@ private:
     {
         ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_OpenOnDoubleClick;
 
-        if (gameObject == selectedObject)
+        if (gameObject->getChildren().empty())
+        {
+            flags |= ImGuiTreeNodeFlags_Leaf;
+        }
+
+        if (gameObject->getHandle() == selectedHandle)
         {
             flags |= ImGuiTreeNodeFlags_Selected;
         }
@@ -173,41 +227,73 @@ private:
 
         if (ImGui::IsItemClicked())
         {
-            selectedObject = gameObject;
+            selectedHandle = gameObject->getHandle();
+        }
+
+        // Drag one node onto another to parent it there
+        if (ImGui::BeginDragDropSource())
+        {
+            GameObjectHandle handle = gameObject->getHandle();
+            ImGui::SetDragDropPayload("GAMEOBJECT", &handle, sizeof(handle));
+            ImGui::Text("%s", gameObject->name.c_str());
+            ImGui::EndDragDropSource();
+        }
+
+        if (ImGui::BeginDragDropTarget())
+        {
+            if (const ImGuiPayload *payload = ImGui::AcceptDragDropPayload("GAMEOBJECT"))
+            {
+                GameObjectHandle child = *static_cast<const GameObjectHandle *>(payload->Data);
+                reparent(child, gameObject->getHandle());
+            }
+            ImGui::EndDragDropTarget();
         }
 
         if (ImGui::BeginPopupContextItem())
         {
+            if (gameObject->getParent() && ImGui::MenuItem("Unparent"))
+            {
+                reparent(gameObject->getHandle(), {});
+            }
             if (ImGui::MenuItem("Delete"))
             {
-                if (selectedObject == gameObject)
-                {
-                    selectedObject = nullptr;
-                }
-                activeScene->removeGameObject(gameObject);
-                ImGui::EndPopup();
-                if (isOpen)
-                {
-                    ImGui::TreePop();
-                }
-                ImGui::PopID();
-                return;
+                // Removed after the hierarchy has been drawn; any handle to the object,
+                // including the selection, goes stale then
+                activeScene->commands().removeGameObject(gameObject->getHandle());
             }
             ImGui::EndPopup();
         }
 
         if (isOpen)
         {
-            // TODO: Render child objects when implementing hierarchy
+            for (GameObject *child : gameObject->getChildren())
+            {
+                renderGameObjectNode(child);
+            }
             ImGui::TreePop();
         }
         ImGui::PopID();
     }
 
+    // Deferred like Delete, since the children lists are being walked while this is called
+    void reparent(GameObjectHandle child, GameObjectHandle parent)
+    {
+        Scene *scene = activeScene;
+        scene->commands().modify(child, [scene, parent](GameObject &gameObject)
+        {
+            GameObject *newParent = parent.isNull() ? nullptr : scene->resolve(parent);
+            if (parent.isNull() || newParent)
+            {
+                scene->setParent(&gameObject, newParent);
+            }
+        });
+    }
+
     void renderInspector()
     {
         if (ImGui::Begin("Inspector"))
         {
+            GameObject *selectedObject = getSelectedObject();
             if (selectedObject)
             {
                 // Object header
@@ -220,10 +306,10 @@ private:
                     if (ImGui::CollapsingHeader("Transform", ImGuiTreeNodeFlags_DefaultOpen))
                     {
                         // Position
-                        glm::vec3 position = transform->position;
+                        glm::vec3 position = transform->getPosition();
                         if (ImGui::DragFloat3("Position", &position[0], 0.1f))
                         {
-                            transform->position = position;
+                            transform->setPosition(position);
                         }
 
                         // Rotation (as Euler angles)
@@ -234,28 +320,28 @@ private:
                         }
 
                         // Scale
-                        glm::vec3 scale = transform->scale;
+                        glm::vec3 scale = transform->getScale();
                         if (ImGui::DragFloat3("Scale", &scale[0], 0.1f))
                         {
-                            transform->scale = scale;
+                            transform->setScale(scale);
                         }
 
                         ImGui::Separator();
                         ImGui::Text("Gizmo Mode:");
 
                         // Gizmo operation radio buttons
-                        bool isTranslate = transform->getGizmoOperation() == ImGuizmo::TRANSLATE;
-                        bool isRotate = transform->getGizmoOperation() == ImGuizmo::ROTATE;
-                        bool isScale = transform->getGizmoOperation() == ImGuizmo::SCALE;
+                        bool isTranslate = gizmoOperation == ImGuizmo::TRANSLATE;
+                        bool isRotate = gizmoOperation == ImGuizmo::ROTATE;
+                        bool isScale = gizmoOperation == ImGuizmo::SCALE;
 
                         if (ImGui::RadioButton("Translate", isTranslate))
-                            transform->setGizmoOperation(ImGuizmo::TRANSLATE);
+                            gizmoOperation = ImGuizmo::TRANSLATE;
                         ImGui::SameLine();
                         if (ImGui::RadioButton("Rotate", isRotate))
-                            transform->setGizmoOperation(ImGuizmo::ROTATE);
+                            gizmoOperation = ImGuizmo::ROTATE;
                         ImGui::SameLine();
                         if (ImGui::RadioButton("Scale", isScale))
-                            transform->setGizmoOperation(ImGuizmo::SCALE);
+                            gizmoOperation = ImGuizmo::SCALE;
                     }
                 }
 
@@ -263,14 +349,14 @@ private:
                 std::string name = selectedObject->name;
                 if (ImGui::InputText("Name", &name))
                 {
-                    selectedObject->name = name;
+                    activeScene->renameGameObject(selectedObject, name);
                 }
 
                 // Active toggle
-                bool isActive = selectedObject->isActive;
+                bool isActive = selectedObject->isActive();
                 if (ImGui::Checkbox("Active", &isActive))
                 {
-                    selectedObject->isActive = isActive;
+                    selectedObject->setActive(isActive);
                 }
 
                 // Static toggle
@@ -289,30 +375,29 @@ private:
 
                 if (ImGui::BeginPopup("AddComponentMenu"))
                 {
-                    if (ImGui::MenuItem("Mesh Renderer"))
-                    {
-                        selectedObject->addComponent<MeshRenderer>();
-                    }
-                    if (ImGui::MenuItem("Light"))
+                    // Every registered component type except the built-in transform
+                    ComponentFactory::getInstance().each([selectedObject](const ComponentType &type)
                     {
-                        selectedObject->addComponent<Light>();
-                    }
-                    if (ImGui::MenuItem("Script"))
-                    {
-                        selectedObject->addComponent<ScriptComponent>();
-                    }
+                        if (type.id == componentTypeId<TransformComponent>())
+                            return;
+
+                        if (ImGui::MenuItem(type.name))
+                        {
+                            selectedObject->addComponent(type);
+                        }
+                    });
                     ImGui::EndPopup();
                 }
 
                 // Render GUI for all components except Transform
-                for (const auto &component : selectedObject->getAllComponents())
+                for (Component *component : selectedObject->getAllComponents())
                 {
-                    if (component->getTypeName() != "TransformComponent")
+                    if (!component->is<TransformComponent>())
                     { // Skip TransformComponent
-                        ImGui::PushID(component.get());
-                        if (ImGui::CollapsingHeader(component->getTypeName().c_str(), ImGuiTreeNodeFlags_DefaultOpen))
+                        ImGui::PushID(component);
+                        if (ImGui::CollapsingHeader(component->getTypeName(), ImGuiTreeNodeFlags_DefaultOpen))
                         {
-                            if (auto *scriptComp = dynamic_cast<ScriptComponent *>(component.get()))
+                            if (auto *scriptComp = component->as<ScriptComponent>())
                             {
                                 // Script component specific GUI
                                 std::string path = scriptComp->scriptPath;
@@ -359,6 +444,39 @@ private:
         ImGui::End();
     }
 
+    /**
+     * @brief Draw the transform gizmo for the selected object.
+     */
+    void renderGizmo()
+    {
+        GameObject *selectedObject = getSelectedObject();
+        if (!selectedObject)
+            return;
+
+        if (auto transform = selectedObject->getTransform())
+        {
+            // Get current view/projection matrices
+            // TODO: Replace with proper camera system
+            glm::mat4 view = glm::lookAt(glm::vec3(0, 5, 10), glm::vec3(0), glm::vec3(0, 1, 0));
+            float aspectRatio = ImGui::GetIO().DisplaySize.x / ImGui::GetIO().DisplaySize.y;
+            glm::mat4 proj = glm::perspective(glm::radians(45.0f), aspectRatio, 0.1f, 1000.0f);
+
+            // Begin ImGuizmo frame
+            ImGuizmo::BeginFrame();
+
+            // Set the viewport for ImGuizmo (should match your rendering viewport)
+            ImGuizmo::SetRect(0, 0, ImGui::GetIO().DisplaySize.x, ImGui::GetIO().DisplaySize.y);
+
+            // Set orthographic mode based on camera
+            ImGuizmo::SetOrthographic(false);
+
+            // Manipulate transform
+            GameObject *parent = selectedObject->getParent();
+            glm::mat4 parentWorld = parent ? parent->getTransform()->getWorldMatrix() : glm::mat4(1.0f);
+            transform->manipulateTransform(view, proj, gizmoOperation, parentWorld);
+        }
+    }
+
     /**
      * @brief Render the toolbar at the top of the window, allowing for scene control.
      */
@@ -412,17 +530,17 @@ private:
         isPlaying = true;
         LOG_INFO("Starting play mode");
 
+        // Everything play mode changes is rolled back from this on Stop
+        playSnapshot.capture(*activeScene);
+
         // Initialize all script components
-        for (const auto &gameObject : activeScene->getAllGameObjects())
+        activeScene->view<ScriptComponent>().each([](Entity, ScriptComponent &script)
         {
-            if (gameObject && gameObject->isActive)
+            if (script.getOwner()->isActive())
             {
-                if (auto script = gameObject->getComponent<ScriptComponent>())
-                {
-                    script->Start();
-                }
+                script.Start();
             }
-        }
+        });
     }
 
     /**
@@ -436,24 +554,23 @@ private:
         isPlaying = false;
         LOG_INFO("Stopping play mode");
 
-        // Clean up scripts if needed
-        for (const auto &gameObject : activeScene->getAllGameObjects())
-        {
-            if (gameObject)
-            {
-                if (auto script = gameObject->getComponent<ScriptComponent>())
-                {
-                    // Reset any script state here if needed
-                }
-            }
-        }
+        // Restoring rebuilds every object, so keep the selection by id. Scripts come back
+        // without their Lua state and start fresh on the next Play.
+        GameObject *selected = getSelectedObject();
+        uint64_t selectedId = selected ? selected->id : 0;
+
+        playSnapshot.restore(*activeScene);
+        playSnapshot.clear();
+
+        GameObject *reselected = selectedId ? activeScene->findGameObjectById(selectedId) : nullptr;
+        selectedHandle = reselected ? reselected->getHandle() : GameObjectHandle();
     }
 
     void createGameObject(const std::string &name)
     {
         if (activeScene)
         {
-            selectedObject = activeScene->createGameObject(name);
+            selectedHandle = activeScene->createGameObject(name)->getHandle();
         }
     }
 
@@ -464,7 +581,7 @@ private:
             auto obj = activeScene->createGameObject("Cube");
             auto renderer = obj->addComponent<MeshRenderer>();
             renderer->setMesh(Resources().getMesh("Cube"));
-            selectedObject = obj;
+            selectedHandle = obj->getHandle();
         }
     }
 
@@ -475,7 +592,7 @@ private:
             auto obj = activeScene->createGameObject("Sphere");
             auto renderer = obj->addComponent<MeshRenderer>();
             renderer->setMesh(Resources().getMesh("Sphere"));
-            selectedObject = obj;
+            selectedHandle = obj->getHandle();
         }
     }
 
@@ -485,11 +602,13 @@ private:
         {
             auto obj = activeScene->createGameObject("Light");
             obj->addComponent<Light>();
-            selectedObject = obj;
+            selectedHandle = obj->getHandle();
         }
     }
 
     Scene *activeScene;
-    GameObject *selectedObject;
+    GameObjectHandle selectedHandle;
+    SceneSnapshot playSnapshot;
     bool isPlaying;
+    ImGuizmo::OPERATION gizmoOperation; // Editor-only, kept out of TransformComponent
 };
@@ -0,0 +1,303 @@
+/**
+ * @file event_bus.h
+ * @brief Typed events posted from any job thread and delivered in batches
+ */
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include "../jobs/job_system.h"
+
+using EventTypeId = uint32_t;
+using SubscriptionId = uint64_t;
+
+// Upper bound on distinct event types
+constexpr EventTypeId MaxEventTypes = 64;
+
+namespace detail
+{
+    inline EventTypeId nextEventTypeId()
+    {
+        static std::atomic<EventTypeId> counter{0};
+        return counter.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+// Dense id for an event type, assigned the first time the type is used
+template <typename E>
+EventTypeId eventTypeId()
+{
+    static const EventTypeId id = detail::nextEventTypeId();
+    assert(id < MaxEventTypes && "Too many event types, raise MaxEventTypes");
+    return id;
+}
+
+/**
+ * @brief Publish/subscribe between components and systems without them knowing each other.
+ *
+ * Any job thread can post() while systems run: each thread appends to its own queue for
+ * the event type, so posting never takes a lock, and the queues keep their capacity from
+ * frame to frame, so a steady stream of events doesn't allocate either. Threads outside
+ * the job system, or workers added since the last setThreadCount(), share one locked
+ * queue. dispatch() runs at a sync point on the main thread and hands each type's
+ * events, thread by thread in the order they were posted, to that type's subscribers.
+ *
+ * Subscribing and unsubscribing happen on the main thread; doing either from inside a
+ * handler is fine. Events of a type nobody has subscribed to are dropped when posted.
+ */
+class EventBus
+{
+public:
+    explicit EventBus(size_t threadCount = 1) : threadCount(std::max<size_t>(1, threadCount)) {}
+
+    EventBus(const EventBus &) = delete;
+    EventBus &operator=(const EventBus &) = delete;
+
+    // Give every channel a queue per job thread. Main thread only, while nobody posts.
+    void setThreadCount(size_t count)
+    {
+        threadCount = std::max(threadCount, count);
+        for (IChannel *channel : ordered)
+        {
+            channel->resize(threadCount);
+        }
+    }
+
+    template <typename E>
+    SubscriptionId subscribe(std::function<void(const E &)> handler)
+    {
+        SubscriptionId id = nextSubscription++;
+        channel<E>().subscribe(id, std::move(handler));
+        subscriptionTypes.emplace_back(id, eventTypeId<E>());
+        return id;
+    }
+
+    void unsubscribe(SubscriptionId id)
+    {
+        auto it = std::find_if(subscriptionTypes.begin(), subscriptionTypes.end(),
+                               [id](const auto &entry) { return entry.first == id; });
+        if (it == subscriptionTypes.end())
+            return;
+
+        channels[it->second].load(std::memory_order_relaxed)->unsubscribe(id);
+        *it = subscriptionTypes.back();
+        subscriptionTypes.pop_back();
+    }
+
+    // Safe from any job thread, including while other threads post the same type
+    template <typename E>
+    void post(E event)
+    {
+        IChannel *base = channels[eventTypeId<E>()].load(std::memory_order_acquire);
+        if (!base)
+            return;
+
+        static_cast<Channel<E> *>(base)->post(std::move(event));
+    }
+
+    /**
+     * @brief Deliver everything posted since the last dispatch.
+     *
+     * Must not overlap with threads posting. Events posted by handlers are delivered in
+     * the same call.
+     */
+    void dispatch()
+    {
+        bool delivered = true;
+        while (delivered)
+        {
+            delivered = false;
+            // By index: a handler subscribing to a new type adds a channel
+            for (size_t i = 0; i < ordered.size(); ++i)
+            {
+                delivered |= ordered[i]->dispatch();
+            }
+        }
+    }
+
+    // Drop undelivered events, keeping subscribers
+    void clear()
+    {
+        for (IChannel *channel : ordered)
+        {
+            channel->clear();
+        }
+    }
+
+private:
+    class IChannel
+    {
+    public:
+        virtual ~IChannel() = default;
+        virtual bool dispatch() = 0;
+        virtual void clear() = 0;
+        virtual void resize(size_t threadCount) = 0;
+        virtual void unsubscribe(SubscriptionId id) = 0;
+    };
+
+    template <typename E>
+    class Channel : public IChannel
+    {
+    public:
+        explicit Channel(size_t threadCount) : queues(threadCount) {}
+
+        void post(E event)
+        {
+            int threadIndex = JobSystem::getThreadIndex();
+            if (threadIndex < 0 || static_cast<size_t>(threadIndex) >= queues.size())
+            {
+                std::lock_guard<std::mutex> lock(sharedMutex);
+                shared.push_back(std::move(event));
+                return;
+            }
+            queues[threadIndex].events.push_back(std::move(event));
+        }
+
+        void resize(size_t threadCount) override
+        {
+            if (queues.size() < threadCount)
+            {
+                queues.resize(threadCount);
+            }
+        }
+
+        void subscribe(SubscriptionId id, std::function<void(const E &)> handler)
+        {
+            // Growing the list mid-dispatch would move the handler that is running
+            (dispatching ? pending : subscribers).push_back({id, std::move(handler), true});
+        }
+
+        void unsubscribe(SubscriptionId id) override
+        {
+            for (auto *list : {&subscribers, &pending})
+            {
+                for (Subscriber &subscriber : *list)
+                {
+                    if (subscriber.id == id)
+                    {
+                        // Flagged rather than erased: the handler may be the one running
+                        subscriber.active = false;
+                        hasEmptySlots = true;
+                    }
+                }
+            }
+        }
+
+        bool dispatch() override
+        {
+            bool delivered = false;
+            dispatching = true;
+            for (Queue &queue : queues)
+            {
+                delivered |= deliver(queue.events);
+            }
+
+            // Taken out under the lock, delivered without it
+            std::vector<E> sharedEvents;
+            {
+                std::lock_guard<std::mutex> lock(sharedMutex);
+                sharedEvents.swap(shared);
+            }
+            delivered |= deliver(sharedEvents);
+            dispatching = false;
+
+            subscribers.insert(subscribers.end(), std::make_move_iterator(pending.begin()),
+                               std::make_move_iterator(pending.end()));
+            pending.clear();
+            if (hasEmptySlots)
+            {
+                subscribers.erase(std::remove_if(subscribers.begin(), subscribers.end(),
+                                                 [](const Subscriber &subscriber) { return !subscriber.active; }),
+                                  subscribers.end());
+                hasEmptySlots = false;
+            }
+            return delivered;
+        }
+
+        void clear() override
+        {
+            for (Queue &queue : queues)
+            {
+                queue.events.clear();
+            }
+            std::lock_guard<std::mutex> lock(sharedMutex);
+            shared.clear();
+        }
+
+    private:
+        struct Subscriber
+        {
+            SubscriptionId id;
+            std::function<void(const E &)> handler;
+            bool active;
+        };
+
+        // One cache line each, so threads appending to neighbouring queues don't contend
+        struct alignas(64) Queue
+        {
+            std::vector<E> events;
+        };
+
+        // Hand events to the subscribers. Events posted meanwhile land in the emptied
+        // queue and go out on the next pass.
+        bool deliver(std::vector<E> &events)
+        {
+            if (events.empty())
+                return false;
+
+            delivering.swap(events);
+            for (const E &event : delivering)
+            {
+                for (size_t i = 0; i < subscribers.size(); ++i)
+                {
+                    if (subscribers[i].active)
+                    {
+                        subscribers[i].handler(event);
+                    }
+                }
+            }
+            delivering.clear();
+            return true;
+        }
+
+        std::vector<Queue> queues; // Indexed by job thread
+        std::mutex sharedMutex;
+        std::vector<E> shared; // Posted from threads without a queue of their own
+        std::vector<E> delivering; // Swapped with a queue while its events are handed out
+        std::vector<Subscriber> subscribers;
+        std::vector<Subscriber> pending; // Subscribed during dispatch
+        bool dispatching = false;
+        bool hasEmptySlots = false;
+    };
+
+    template <typename E>
+    Channel<E> &channel()
+    {
+        EventTypeId type = eventTypeId<E>();
+        IChannel *existing = channels[type].load(std::memory_order_relaxed);
+        if (existing)
+        {
+            return *static_cast<Channel<E> *>(existing);
+        }
+
+        owned.push_back(std::make_unique<Channel<E>>(threadCount));
+        ordered.push_back(owned.back().get());
+        channels[type].store(owned.back().get(), std::memory_order_release);
+        return *static_cast<Channel<E> *>(owned.back().get());
+    }
+
+    size_t threadCount;
+    std::array<std::atomic<IChannel *>, MaxEventTypes> channels{}; // Read by posting threads
+    std::vector<std::unique_ptr<IChannel>> owned;
+    std::vector<IChannel *> ordered; // Creation order, the order types are dispatched in
+    std::vector<std::pair<SubscriptionId, EventTypeId>> subscriptionTypes;
+    SubscriptionId nextSubscription = 1;
+};
@@ -5,35 +5,68 @@
 #include "components/light.h"
 #include "components/script_component.h"
 #include "serialization.h"
+#include "component_factory.h"
+#include "ecs/entity_registry.h"
+#include "gameobject_handle.h"
+#include "../helpers/logging.h"
 #include <memory>
 #include <vector>
 #include <string>
-#include <typeinfo>
 #include <algorithm>
 #include <atomic>
 
 class GameObject : public ISerializable
 {
 public:
-    GameObject(const std::string &objectName = "GameObject")
-        : id(nextId++), name(objectName), isStatic(false), isActive(true)
+    // uniqueName appends the id to the name; prefab instances share their prefab's name instead
+    GameObject(EntityRegistry *registry, const std::string &objectName = "GameObject", bool uniqueName = true)
+        : id(nextId++), name(objectName), isStatic(false),
+          registry(registry), entity(registry->create()), active(true), transformComponent(nullptr), parent(nullptr)
     {
-        name = objectName + " (" + std::to_string(id) + ")";
+        if (uniqueName)
+        {
+            name = objectName + " (" + std::to_string(id) + ")";
+        }
         transformComponent = addComponent<TransformComponent>();
     }
 
+    ~GameObject()
+    {
+        registry->destroy(entity);
+    }
+
+    // Components live in the registry's pools and point back at their owner
+    GameObject(const GameObject &) = delete;
+    GameObject &operator=(const GameObject &) = delete;
+
     // Object properties
     uint64_t id; // Removed const to allow deserialization
     std::string name;
     bool isStatic;
-    bool isActive;
+
+    bool isActive() const
+    {
+        return active;
+    }
+
+    // Inactive objects keep their components but drop out of every update and render list
+    void setActive(bool value)
+    {
+        if (active == value)
+            return;
+        active = value;
+        for (Component *component : components)
+        {
+            component->setOwnerActive(active);
+        }
+    }
 
     // Transform operations
     void setPosition(const glm::vec3 &pos)
     {
         if (transformComponent)
         {
-            transformComponent->position = pos;
+            transformComponent->setPosition(pos);
         }
     }
 
@@ -49,14 +82,14 @@ public:
     {
         if (transformComponent)
         {
-            transformComponent->scale = scl;
+            transformComponent->setScale(scl);
         }
     }
 
     // Getters
     glm::vec3 getPosition() const
     {
-        return transformComponent ? transformComponent->position : glm::vec3(0.0f);
+        return transformComponent ? transformComponent->getPosition() : glm::vec3(0.0f);
     }
 
     glm::vec3 getRotation() const
@@ -66,12 +99,12 @@ public:
 
     glm::vec3 getScale() const
     {
-        return transformComponent ? transformComponent->scale : glm::vec3(1.0f);
+        return transformComponent ? transformComponent->getScale() : glm::vec3(1.0f);
     }
 
     glm::mat4 getModelMatrix() const
     {
-        return transformComponent ? transformComponent->getLocalMatrix() : glm::mat4(1.0f);
+        return transformComponent ? transformComponent->getWorldMatrix() : glm::mat4(1.0f);
     }
 
     TransformComponent *getTransform() const
@@ -79,63 +112,102 @@ public:
         return transformComponent;
     }
 
+    // Hierarchy; change it through Scene::setParent so the scene's transform order follows
+    GameObject *getParent() const
+    {
+        return parent;
+    }
+
+    const std::vector<GameObject *> &getChildren() const
+    {
+        return children;
+    }
+
+    Entity getEntity() const
+    {
+        return entity;
+    }
+
+    // Assigned by the owning Scene; stays valid to resolve until the object is removed
+    GameObjectHandle getHandle() const
+    {
+        return handle;
+    }
+
+    void setHandle(GameObjectHandle newHandle)
+    {
+        handle = newHandle;
+    }
+
     // Component management
+    // Components are stored per type in the registry, so an object holds at most one
+    // component of each type. Adding a type that is already present returns the existing one.
     template <typename T>
     T *addComponent()
     {
         static_assert(std::is_base_of<Component, T>::value, "T must derive from Component");
 
-        auto component = std::make_unique<T>();
-        T *componentPtr = component.get();
-        component->setOwner(this);
+        if (T *existing = registry->tryGet<T>(entity))
+        {
+            return existing;
+        }
 
-        // Convert to base class pointer before moving into vector
-        components.push_back(std::unique_ptr<Component>(component.release()));
+        T *componentPtr = registry->emplace<T>(entity);
+        attachComponent(componentPtr, componentTypeId<T>());
+        return componentPtr;
+    }
 
-        if (auto transform = dynamic_cast<TransformComponent *>(componentPtr))
+    // Add a component from its factory entry, for when the type is only known at runtime
+    Component *addComponent(const ComponentType &type)
+    {
+        if (Component *existing = registry->tryGet(type.id, entity))
         {
-            transformComponent = transform;
+            return existing;
         }
 
-        return componentPtr;
+        Component *component = type.create(*registry, entity);
+        attachComponent(component, type.id);
+        return component;
     }
 
+    // O(1): a bit test on the entity's component mask, then a sparse-set lookup.
+    // Matches the exact component type only.
     template <typename T>
     T *getComponent() const
     {
-        for (const auto &component : components)
-        {
-            if (auto typed = dynamic_cast<T *>(component.get()))
-            {
-                return typed;
-            }
-        }
-        return nullptr;
+        return registry->tryGet<T>(entity);
     }
 
-    const std::vector<std::unique_ptr<Component>> &getAllComponents() const
+    template <typename T>
+    bool hasComponent() const
     {
-        return components;
+        return registry->has<T>(entity);
     }
 
-    void clearComponents()
+    const std::vector<Component *> &getAllComponents() const
     {
-        components.clear();
-        transformComponent = nullptr;
+        return components;
     }
 
-    // Update
-    void update(float deltaTime)
+    // The transform can't be removed; every object has one
+    template <typename T>
+    void removeComponent()
     {
-        if (!isActive)
+        static_assert(!std::is_same<T, TransformComponent>::value, "Every GameObject keeps its transform");
+
+        T *component = registry->tryGet<T>(entity);
+        if (!component)
             return;
-        for (const auto &component : components)
-        {
-            if (component->isEnabled())
-            {
-                component->Update(deltaTime);
-            }
-        }
+
+        components.erase(std::find(components.begin(), components.end(), component));
+        registry->remove<T>(entity);
+    }
+
+    void clearComponents()
+    {
+        registry->removeAll(entity);
+        components.clear();
+        transformComponent = nullptr;
     }
 
     // Serialization
@@ -144,11 +216,15 @@ public:
         j["id"] = id;
         j["name"] = name;
         j["isStatic"] = isStatic;
-        j["isActive"] = isActive;
+        j["isActive"] = active;
+        if (parent)
+        {
+            j["parent"] = parent->id; // Linked up by Scene::deserialize once every object exists
+        }
 
         // Serialize components
         json componentsArray = json::array();
-        for (const auto &component : components)
+        for (const Component *component : components)
         {
             json componentJson;
             component->serialize(componentJson);
@@ -164,43 +240,24 @@ public:
 
         // Deserialize basic properties
         id = j["id"].get<uint64_t>();
+        reserveId(id);
         name = j["name"].get<std::string>();
         isStatic = j["isStatic"].get<bool>();
-        isActive = j["isActive"].get<bool>();
+        active = j["isActive"].get<bool>();
 
-        // Deserialize components
+        // Deserialize components, one factory lookup per component
         const auto &componentsArray = j["components"];
         for (const auto &componentJson : componentsArray)
         {
-            std::string typeName = componentJson["type"].get<std::string>();
-
-            std::unique_ptr<Component> component;
-
-            // Create appropriate component type
-            if (typeName == "TransformComponent")
+            const std::string &typeName = componentJson["type"].get_ref<const std::string &>();
+            const ComponentType *type = ComponentFactory::getInstance().find(typeName);
+            if (!type)
             {
-                component = std::make_unique<TransformComponent>();
-                transformComponent = static_cast<TransformComponent *>(component.get());
-            }
-            else if (typeName == "MeshRenderer")
-            {
-                component = std::make_unique<MeshRenderer>();
-            }
-            else if (typeName == "Light")
-            {
-                component = std::make_unique<Light>();
-            }
-            else if (typeName == "ScriptComponent")
-            {
-                component = std::make_unique<ScriptComponent>();
+                LOG_WARNING("Skipping unknown component type {}", typeName);
+                continue;
             }
 
-            if (component)
-            {
-                component->setOwner(this);
-                component->deserialize(componentJson);
-                components.push_back(std::move(component));
-            }
+            addComponent(*type)->deserialize(componentJson);
         }
 
         // Ensure we have a transform component
@@ -211,7 +268,38 @@ public:
     }
 
 private:
+    friend class Scene;
+    friend class SceneSnapshot;
+
+    // Make sure freshly created objects never reuse an id loaded from a file
+    static void reserveId(uint64_t usedId)
+    {
+        uint64_t expected = nextId.load();
+        while (expected <= usedId && !nextId.compare_exchange_weak(expected, usedId + 1))
+        {
+        }
+    }
+
+    void attachComponent(Component *component, ComponentTypeId type)
+    {
+        component->setOwner(this);
+        component->setTypeId(type);
+        component->setOwnerActive(active);
+        components.push_back(component);
+
+        if (type == componentTypeId<TransformComponent>())
+        {
+            transformComponent = static_cast<TransformComponent *>(component);
+        }
+    }
+
+    EntityRegistry *registry;
+    Entity entity;
+    bool active;
+    GameObjectHandle handle;
     TransformComponent *transformComponent;
-    std::vector<std::unique_ptr<Component>> components;
+    std::vector<Component *> components; // Non-owning, in the order they were added
+    GameObject *parent;
+    std::vector<GameObject *> children;
     static std::atomic<uint64_t> nextId;
 };
\ No newline at end of file
@@ -0,0 +1,32 @@
+/**
+ * @file gameobject_handle.h
+ * @brief Generational handle for referring to a GameObject without owning it
+ */
+#pragma once
+#include <cstdint>
+
+/**
+ * @brief Slot index plus the generation the slot had when the handle was made.
+ *
+ * Removing an object bumps its slot's generation, so handles that outlive the object
+ * resolve to null instead of dangling. Resolve with Scene::resolve().
+ */
+struct GameObjectHandle
+{
+    static constexpr uint32_t NullIndex = UINT32_MAX;
+
+    uint32_t index = NullIndex;
+    uint32_t generation = 0;
+
+    bool isNull() const { return index == NullIndex; }
+
+    bool operator==(const GameObjectHandle &other) const
+    {
+        return index == other.index && generation == other.generation;
+    }
+
+    bool operator!=(const GameObjectHandle &other) const
+    {
+        return !(*this == other);
+    }
+};
@@ -0,0 +1,312 @@
+/**
+ * @file job_system.cpp
+ * @brief Work-stealing job scheduler shared by the whole engine
+ */
+#include <algorithm>
+#include <exception>
+
+#include "job_system.h"
+#include "../../helpers/logging.h"
+
+struct Job
+{
+    std::function<void()> work;
+    std::shared_ptr<Job> parent;
+
+    // The job itself plus any children spawned while it runs (parallelFor batches)
+    std::atomic<int> unfinished{1};
+
+    // Unfinished dependencies, plus one held by schedule() until setup is complete
+    std::atomic<int> pendingDependencies{1};
+
+    std::mutex continuationMutex;
+    std::vector<std::shared_ptr<Job>> continuations;
+    bool done = false; // Guarded by continuationMutex
+};
+
+namespace
+{
+    thread_local int t_threadIndex = -1;
+}
+
+bool JobHandle::isDone() const
+{
+    if (!job)
+        return true;
+
+    std::lock_guard<std::mutex> lock(job->continuationMutex);
+    return job->done;
+}
+
+int JobSystem::getThreadIndex()
+{
+    return t_threadIndex;
+}
+
+void JobSystem::initialize(unsigned threadCount)
+{
+    if (running)
+        return;
+
+    if (threadCount == 0)
+    {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    queues.clear();
+    for (unsigned i = 0; i < threadCount; ++i)
+    {
+        queues.push_back(std::make_unique<WorkQueue>());
+    }
+
+    running = true;
+    t_threadIndex = 0;
+    for (unsigned i = 1; i < threadCount; ++i)
+    {
+        workers.emplace_back(&JobSystem::workerLoop, this, i);
+    }
+
+    LOG_INFO("Job system started with {} threads", threadCount);
+}
+
+void JobSystem::shutdown()
+{
+    if (!running)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        running = false;
+    }
+    wakeCondition.notify_all();
+
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+    workers.clear();
+    queues.clear();
+    queuedJobs = 0;
+    t_threadIndex = -1;
+}
+
+JobHandle JobSystem::schedule(std::function<void()> work, std::initializer_list<JobHandle> dependencies)
+{
+    JobHandle handle = createJob(std::move(work), nullptr);
+    addDependencies(handle.job, dependencies.begin(), dependencies.end());
+    submit(handle.job);
+    return handle;
+}
+
+JobHandle JobSystem::schedule(std::function<void()> work, const std::vector<JobHandle> &dependencies)
+{
+    JobHandle handle = createJob(std::move(work), nullptr);
+    addDependencies(handle.job, dependencies.data(), dependencies.data() + dependencies.size());
+    submit(handle.job);
+    return handle;
+}
+
+JobHandle JobSystem::parallelFor(size_t count, size_t batchSize, std::function<void(size_t, size_t)> fn,
+                                 std::initializer_list<JobHandle> dependencies)
+{
+    batchSize = std::max<size_t>(1, batchSize);
+
+    // The parent job fans the batches out once its dependencies are met. Each batch is a
+    // child, so the parent only finishes after every batch has.
+    auto body = std::make_shared<std::function<void(size_t, size_t)>>(std::move(fn));
+    auto self = std::make_shared<std::weak_ptr<Job>>(); // Weak, so the job doesn't own itself
+
+    JobHandle handle = createJob([this, count, batchSize, body, self]()
+    {
+        std::shared_ptr<Job> parent = self->lock();
+        for (size_t begin = 0; begin < count; begin += batchSize)
+        {
+            size_t end = std::min(count, begin + batchSize);
+            JobHandle child = createJob([body, begin, end]() { (*body)(begin, end); }, parent);
+            submit(child.job);
+        }
+    }, nullptr);
+
+    *self = handle.job;
+    addDependencies(handle.job, dependencies.begin(), dependencies.end());
+    submit(handle.job);
+    return handle;
+}
+
+void JobSystem::wait(const JobHandle &handle)
+{
+    unsigned threadIndex = t_threadIndex > 0 ? static_cast<unsigned>(t_threadIndex) : 0;
+    while (!handle.isDone())
+    {
+        if (auto job = takeJob(threadIndex))
+        {
+            execute(job);
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+JobHandle JobSystem::createJob(std::function<void()> work, std::shared_ptr<Job> parent)
+{
+    auto job = std::make_shared<Job>();
+    job->work = std::move(work);
+    if (parent)
+    {
+        // Children keep their parent alive, and unfinished, until they are done
+        parent->unfinished.fetch_add(1);
+        job->parent = std::move(parent);
+    }
+    return JobHandle(job);
+}
+
+void JobSystem::addDependencies(const std::shared_ptr<Job> &job, const JobHandle *begin, const JobHandle *end)
+{
+    for (const JobHandle *dependency = begin; dependency != end; ++dependency)
+    {
+        if (!dependency->job)
+            continue;
+
+        std::lock_guard<std::mutex> lock(dependency->job->continuationMutex);
+        if (!dependency->job->done)
+        {
+            job->pendingDependencies.fetch_add(1);
+            dependency->job->continuations.push_back(job);
+        }
+    }
+}
+
+void JobSystem::submit(std::shared_ptr<Job> job)
+{
+    // Drop the setup reference; whoever brings the count to zero queues the job
+    if (job->pendingDependencies.fetch_sub(1) == 1)
+    {
+        enqueue(std::move(job));
+    }
+}
+
+void JobSystem::enqueue(std::shared_ptr<Job> job)
+{
+    // Without worker threads, run everything inline on the calling thread
+    if (!running)
+    {
+        execute(job);
+        return;
+    }
+
+    unsigned threadIndex = t_threadIndex > 0 ? static_cast<unsigned>(t_threadIndex) : 0;
+    {
+        std::lock_guard<std::mutex> lock(queues[threadIndex]->mutex);
+        queues[threadIndex]->jobs.push_back(std::move(job));
+    }
+    queuedJobs.fetch_add(1);
+
+    // Taking the lock orders this with a worker that is about to sleep, so the wake-up
+    // can't slip in between its check and its wait
+    if (sleepingWorkers.load() > 0)
+    {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+        }
+        wakeCondition.notify_one();
+    }
+}
+
+void JobSystem::execute(const std::shared_ptr<Job> &job)
+{
+    try
+    {
+        if (job->work)
+        {
+            job->work();
+        }
+    }
+    catch (const std::exception &e)
+    {
+        LOG_ERROR("Unhandled exception in job: {}", e.what());
+    }
+    finish(job.get());
+}
+
+void JobSystem::finish(Job *job)
+{
+    if (job->unfinished.fetch_sub(1) != 1)
+        return;
+
+    std::vector<std::shared_ptr<Job>> ready;
+    {
+        std::lock_guard<std::mutex> lock(job->continuationMutex);
+        job->done = true;
+        ready.swap(job->continuations);
+    }
+
+    for (auto &continuation : ready)
+    {
+        submit(std::move(continuation));
+    }
+
+    if (job->parent)
+    {
+        std::shared_ptr<Job> parent = std::move(job->parent);
+        finish(parent.get());
+    }
+}
+
+std::shared_ptr<Job> JobSystem::takeJob(unsigned threadIndex)
+{
+    if (queuedJobs.load() == 0)
+        return nullptr;
+
+    // Newest job from our own queue first: its data is most likely still in cache
+    {
+        WorkQueue &own = *queues[threadIndex];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.jobs.empty())
+        {
+            auto job = std::move(own.jobs.back());
+            own.jobs.pop_back();
+            queuedJobs.fetch_sub(1);
+            return job;
+        }
+    }
+
+    // Otherwise steal the oldest job from someone else
+    for (size_t offset = 1; offset < queues.size(); ++offset)
+    {
+        WorkQueue &victim = *queues[(threadIndex + offset) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.jobs.empty())
+        {
+            auto job = std::move(victim.jobs.front());
+            victim.jobs.pop_front();
+            queuedJobs.fetch_sub(1);
+            return job;
+        }
+    }
+
+    return nullptr;
+}
+
+void JobSystem::workerLoop(unsigned threadIndex)
+{
+    t_threadIndex = static_cast<int>(threadIndex);
+
+    while (running)
+    {
+        if (auto job = takeJob(threadIndex))
+        {
+            execute(job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        sleepingWorkers.fetch_add(1);
+        wakeCondition.wait(lock, [this]()
+        {
+            return !running || queuedJobs.load() > 0;
+        });
+        sleepingWorkers.fetch_sub(1);
+    }
+}
@@ -0,0 +1,123 @@
+/**
+ * @file job_system.h
+ * @brief Work-stealing job scheduler shared by the whole engine
+ */
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct Job;
+
+/**
+ * @brief Reference to a scheduled job, used for dependencies and waiting.
+ *
+ * A default-constructed handle refers to no job and counts as already finished.
+ */
+class JobHandle
+{
+public:
+    JobHandle() = default;
+
+    bool isValid() const { return job != nullptr; }
+    bool isDone() const;
+
+private:
+    friend class JobSystem;
+    explicit JobHandle(std::shared_ptr<Job> job) : job(std::move(job)) {}
+
+    std::shared_ptr<Job> job;
+};
+
+/**
+ * @brief One worker thread per core, each with its own deque of jobs.
+ *
+ * Workers push and pop jobs at the back of their own deque and steal from the front
+ * of other workers' deques when they run dry, so most scheduling stays thread-local.
+ * The thread that called initialize() (normally the main thread) is worker 0: it never
+ * blocks in wait(), it runs queued jobs until the awaited job is finished.
+ */
+class JobSystem
+{
+public:
+    static JobSystem &getInstance()
+    {
+        static JobSystem instance;
+        return instance;
+    }
+
+    JobSystem(const JobSystem &) = delete;
+    JobSystem &operator=(const JobSystem &) = delete;
+
+    /**
+     * @brief Start the worker threads.
+     * @param threadCount Total threads including the calling one; 0 uses one per core.
+     */
+    void initialize(unsigned threadCount = 0);
+    void shutdown();
+
+    /**
+     * @brief Queue a job. It starts once every job in dependencies has finished.
+     */
+    JobHandle schedule(std::function<void()> work, std::initializer_list<JobHandle> dependencies = {});
+    JobHandle schedule(std::function<void()> work, const std::vector<JobHandle> &dependencies);
+
+    /**
+     * @brief Split [0, count) into batches and run fn(begin, end) on each in parallel.
+     * @return A handle that finishes once every batch has finished.
+     */
+    JobHandle parallelFor(size_t count, size_t batchSize, std::function<void(size_t, size_t)> fn,
+                          std::initializer_list<JobHandle> dependencies = {});
+
+    /**
+     * @brief Block until the job has finished, running other jobs in the meantime.
+     */
+    void wait(const JobHandle &handle);
+
+    // Number of threads that run jobs, including the main thread
+    unsigned getThreadCount() const { return static_cast<unsigned>(queues.size()); }
+
+    // Index of the calling thread: 0 for the main thread, 1..N-1 for workers, -1 otherwise
+    static int getThreadIndex();
+
+private:
+    struct WorkQueue
+    {
+        std::mutex mutex;
+        std::deque<std::shared_ptr<Job>> jobs;
+    };
+
+    JobSystem() {}
+    ~JobSystem() { shutdown(); }
+
+    JobHandle createJob(std::function<void()> work, std::shared_ptr<Job> parent);
+    void addDependencies(const std::shared_ptr<Job> &job, const JobHandle *begin, const JobHandle *end);
+    void submit(std::shared_ptr<Job> job);
+    void enqueue(std::shared_ptr<Job> job);
+    void execute(const std::shared_ptr<Job> &job);
+    void finish(Job *job);
+    std::shared_ptr<Job> takeJob(unsigned threadIndex);
+    void workerLoop(unsigned threadIndex);
+
+    std::vector<std::unique_ptr<WorkQueue>> queues; // One per thread, index 0 is the main thread
+    std::vector<std::thread> workers;
+    std::atomic<bool> running{false};
+    std::atomic<size_t> queuedJobs{0};
+    std::atomic<unsigned> sleepingWorkers{0};
+
+    std::mutex sleepMutex;
+    std::condition_variable wakeCondition;
+};
+
+// Convenience function to get the job system instance
+inline JobSystem &Jobs()
+{
+    return JobSystem::getInstance();
+}
@@ -0,0 +1,45 @@
+/**
+ * @file bounds.h
+ * @brief Axis-aligned boxes and spheres bounding meshes and objects
+ */
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <glm/glm.hpp>
+
+struct BoundingBox
+{
+    glm::vec3 min{0.0f};
+    glm::vec3 max{0.0f};
+
+    glm::vec3 getCenter() const { return (min + max) * 0.5f; }
+    glm::vec3 getExtents() const { return (max - min) * 0.5f; } // Half size
+
+    // The box around this box after transform; may be larger than the transformed contents
+    BoundingBox transformed(const glm::mat4 &transform) const
+    {
+        glm::vec3 center = glm::vec3(transform * glm::vec4(getCenter(), 1.0f));
+        glm::vec3 extents = getExtents();
+
+        // Each world axis gets the absolute projection of every rotated, scaled local axis
+        glm::mat3 basis(transform);
+        glm::vec3 worldExtents = glm::abs(basis[0]) * extents.x + glm::abs(basis[1]) * extents.y +
+                                 glm::abs(basis[2]) * extents.z;
+        return {center - worldExtents, center + worldExtents};
+    }
+};
+
+struct BoundingSphere
+{
+    glm::vec3 center{0.0f};
+    float radius = 0.0f;
+
+    // The radius grows by the largest axis scale, so non-uniform scaling stays conservative
+    BoundingSphere transformed(const glm::mat4 &transform) const
+    {
+        float scale = std::sqrt(std::max({glm::dot(glm::vec3(transform[0]), glm::vec3(transform[0])),
+                                          glm::dot(glm::vec3(transform[1]), glm::vec3(transform[1])),
+                                          glm::dot(glm::vec3(transform[2]), glm::vec3(transform[2]))}));
+        return {glm::vec3(transform * glm::vec4(center, 1.0f)), radius * scale};
+    }
+};
@@ -0,0 +1,359 @@
+/**
+ * @file bvh.cpp
+ * @brief Bounding volume hierarchy over boxes, for culling and proximity queries
+ */
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "bvh.h"
+
+namespace
+{
+    constexpr int BinCount = 12;
+
+    // Grows to the first box merged into it
+    BoundingBox emptyBox()
+    {
+        float infinity = std::numeric_limits<float>::infinity();
+        return {glm::vec3(infinity), glm::vec3(-infinity)};
+    }
+
+    void grow(BoundingBox &box, const BoundingBox &other)
+    {
+        box.min = glm::min(box.min, other.min);
+        box.max = glm::max(box.max, other.max);
+    }
+
+    void grow(BoundingBox &box, const glm::vec3 &point)
+    {
+        box.min = glm::min(box.min, point);
+        box.max = glm::max(box.max, point);
+    }
+
+    float surfaceArea(const BoundingBox &box)
+    {
+        glm::vec3 size = glm::max(box.max - box.min, glm::vec3(0.0f));
+        return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+    }
+
+    struct Bin
+    {
+        BoundingBox bounds = emptyBox();
+        uint32_t count = 0;
+    };
+}
+
+void Bvh::clear()
+{
+    nodes.clear();
+    itemIds.clear();
+    itemSlots.clear();
+    itemCenters.clear();
+    itemExtents.clear();
+    itemRadii.clear();
+}
+
+void Bvh::build(const BoundingBox *boxes, const float *radii, size_t count)
+{
+    clear();
+    if (count == 0)
+        return;
+
+    itemIds.resize(count);
+    buildCentroids.resize(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        itemIds[i] = static_cast<uint32_t>(i);
+        buildCentroids[i] = boxes[i].getCenter();
+    }
+
+    nodes.reserve(2 * count / MaxLeafSize + 1);
+    buildNodes(static_cast<uint32_t>(count), boxes);
+
+    // Copy the bounds into leaf order so leaves are tested straight from contiguous arrays
+    itemSlots.resize(count);
+    itemCenters.resize(count);
+    itemExtents.resize(count);
+    itemRadii.resize(count);
+    for (uint32_t slot = 0; slot < count; ++slot)
+    {
+        uint32_t item = itemIds[slot];
+        itemSlots[item] = slot;
+        itemCenters[slot] = boxes[item].getCenter();
+        itemExtents[slot] = boxes[item].getExtents();
+        itemRadii[slot] = radii[item];
+    }
+}
+
+void Bvh::buildNodes(uint32_t count, const BoundingBox *boxes)
+{
+    // Work on an explicit stack; levels can get deep when items are unevenly spread
+    struct Task
+    {
+        uint32_t node;
+        uint32_t first;
+        uint32_t count;
+    };
+    std::vector<Task> stack;
+    nodes.push_back({});
+    stack.push_back({0, 0, count});
+
+    while (!stack.empty())
+    {
+        Task task = stack.back();
+        stack.pop_back();
+
+        BoundingBox bounds = emptyBox();
+        BoundingBox centroidBounds = emptyBox();
+        for (uint32_t i = task.first; i < task.first + task.count; ++i)
+        {
+            grow(bounds, boxes[itemIds[i]]);
+            grow(centroidBounds, buildCentroids[itemIds[i]]);
+        }
+        nodes[task.node] = {bounds, task.first, task.count, 0};
+
+        if (task.count <= MaxLeafSize)
+            continue;
+
+        // Bin the centroids along the widest axis and pick the cheapest split by SAH
+        glm::vec3 centroidSize = centroidBounds.max - centroidBounds.min;
+        int axis = centroidSize.x > centroidSize.y ? (centroidSize.x > centroidSize.z ? 0 : 2)
+                                                   : (centroidSize.y > centroidSize.z ? 1 : 2);
+        float axisMin = centroidBounds.min[axis];
+        float axisSize = centroidSize[axis];
+
+        // If every centroid coincides, any split is as good as another
+        uint32_t split = task.first + task.count / 2;
+        if (axisSize > 0.0f)
+        {
+            Bin bins[BinCount];
+            float scale = BinCount / axisSize;
+            auto binOf = [&](uint32_t item)
+            {
+                int bin = static_cast<int>((buildCentroids[item][axis] - axisMin) * scale);
+                return std::min(bin, BinCount - 1);
+            };
+
+            for (uint32_t i = task.first; i < task.first + task.count; ++i)
+            {
+                Bin &bin = bins[binOf(itemIds[i])];
+                grow(bin.bounds, boxes[itemIds[i]]);
+                ++bin.count;
+            }
+
+            // Sweep from the right for the area and count of everything past each plane
+            float rightArea[BinCount - 1];
+            uint32_t rightCount[BinCount - 1];
+            BoundingBox rightBox = emptyBox();
+            uint32_t rightSum = 0;
+            for (int plane = BinCount - 1; plane > 0; --plane)
+            {
+                grow(rightBox, bins[plane].bounds);
+                rightSum += bins[plane].count;
+                rightArea[plane - 1] = surfaceArea(rightBox);
+                rightCount[plane - 1] = rightSum;
+            }
+
+            int bestPlane = -1;
+            float bestCost = std::numeric_limits<float>::infinity();
+            BoundingBox leftBox = emptyBox();
+            uint32_t leftSum = 0;
+            for (int plane = 0; plane < BinCount - 1; ++plane)
+            {
+                grow(leftBox, bins[plane].bounds);
+                leftSum += bins[plane].count;
+                if (leftSum == 0 || rightCount[plane] == 0)
+                    continue;
+
+                float cost = surfaceArea(leftBox) * leftSum + rightArea[plane] * rightCount[plane];
+                if (cost < bestCost)
+                {
+                    bestCost = cost;
+                    bestPlane = plane;
+                }
+            }
+
+            if (bestPlane >= 0)
+            {
+                uint32_t *begin = itemIds.data() + task.first;
+                uint32_t *middle = std::partition(begin, begin + task.count, [&](uint32_t item)
+                {
+                    return binOf(item) <= bestPlane;
+                });
+                split = static_cast<uint32_t>(middle - itemIds.data());
+            }
+        }
+
+        uint32_t left = static_cast<uint32_t>(nodes.size());
+        nodes.push_back({});
+        nodes.push_back({});
+        nodes[task.node].leftChild = left;
+
+        stack.push_back({left + 1, split, task.first + task.count - split});
+        stack.push_back({left, task.first, split - task.first});
+    }
+}
+
+void Bvh::setItemBounds(uint32_t item, const BoundingBox &box, float radius)
+{
+    uint32_t slot = itemSlots[item];
+    itemCenters[slot] = box.getCenter();
+    itemExtents[slot] = box.getExtents();
+    itemRadii[slot] = radius;
+}
+
+void Bvh::refit()
+{
+    // Children always come after their parent, so a reverse walk sees them first
+    for (size_t i = nodes.size(); i-- > 0;)
+    {
+        Node &node = nodes[i];
+        if (node.leftChild)
+        {
+            node.bounds = nodes[node.leftChild].bounds;
+            grow(node.bounds, nodes[node.leftChild + 1].bounds);
+            continue;
+        }
+
+        node.bounds = emptyBox();
+        for (uint32_t slot = node.firstItem; slot < node.firstItem + node.itemCount; ++slot)
+        {
+            grow(node.bounds, {itemCenters[slot] - itemExtents[slot], itemCenters[slot] + itemExtents[slot]});
+        }
+    }
+}
+
+float Bvh::getCost() const
+{
+    if (nodes.empty())
+        return 0.0f;
+
+    float rootArea = surfaceArea(nodes[0].bounds);
+    if (rootArea <= 0.0f)
+        return 0.0f;
+
+    float total = 0.0f;
+    for (const Node &node : nodes)
+    {
+        total += surfaceArea(node.bounds) * (node.leftChild ? 1.0f : static_cast<float>(node.itemCount));
+    }
+    return total / rootArea;
+}
+
+void Bvh::cull(const Frustum &frustum, std::vector<uint32_t> &out) const
+{
+    if (nodes.empty())
+        return;
+
+    // Planes a node lies entirely inside are dropped for its whole subtree
+    constexpr uint8_t AllPlanes = 0x3F;
+    struct Entry
+    {
+        uint32_t node;
+        uint8_t planes;
+    };
+    Entry stack[64];
+    int top = 0;
+    stack[top++] = {0, AllPlanes};
+
+    while (top > 0)
+    {
+        Entry entry = stack[--top];
+        const Node &node = nodes[entry.node];
+
+        glm::vec3 center = node.bounds.getCenter();
+        glm::vec3 extents = node.bounds.getExtents();
+        uint8_t planes = entry.planes;
+        bool outside = false;
+        for (int p = 0; p < 6 && !outside; ++p)
+        {
+            if (!(planes & (1u << p)))
+                continue;
+
+            const glm::vec4 &plane = frustum.planes[p];
+            float distance = glm::dot(glm::vec3(plane), center) + plane.w;
+            float radius = glm::dot(glm::abs(glm::vec3(plane)), extents);
+            if (distance + radius < 0.0f)
+                outside = true;
+            else if (distance - radius >= 0.0f)
+                planes &= static_cast<uint8_t>(~(1u << p));
+        }
+        if (outside)
+            continue;
+
+        if (planes == 0)
+        {
+            out.insert(out.end(), itemIds.begin() + node.firstItem, itemIds.begin() + node.firstItem + node.itemCount);
+            continue;
+        }
+
+        if (!node.leftChild)
+        {
+            uint8_t visible[MaxLeafSize];
+            cullAgainstFrustum(frustum, &itemCenters[node.firstItem], &itemExtents[node.firstItem],
+                               &itemRadii[node.firstItem], node.itemCount, visible);
+            for (uint32_t k = 0; k < node.itemCount; ++k)
+            {
+                if (visible[k])
+                    out.push_back(itemIds[node.firstItem + k]);
+            }
+            continue;
+        }
+
+        // The tree is at most a few dozen levels deep for any realistic item count, but a
+        // badly clustered one could go further; fall back to testing the range directly
+        if (top + 2 > static_cast<int>(sizeof(stack) / sizeof(stack[0])))
+        {
+            for (uint32_t slot = node.firstItem; slot < node.firstItem + node.itemCount; slot += MaxLeafSize)
+            {
+                uint32_t n = std::min(MaxLeafSize, node.firstItem + node.itemCount - slot);
+                uint8_t visible[MaxLeafSize];
+                cullAgainstFrustum(frustum, &itemCenters[slot], &itemExtents[slot], &itemRadii[slot], n, visible);
+                for (uint32_t k = 0; k < n; ++k)
+                {
+                    if (visible[k])
+                        out.push_back(itemIds[slot + k]);
+                }
+            }
+            continue;
+        }
+        stack[top++] = {node.leftChild + 1, planes};
+        stack[top++] = {node.leftChild, planes};
+    }
+}
+
+void Bvh::queryDistance(const glm::vec3 &point, float maxDistance, std::vector<uint32_t> &out) const
+{
+    if (nodes.empty())
+        return;
+
+    float maxDistanceSquared = maxDistance * maxDistance;
+    auto distanceSquared = [&point](const glm::vec3 &center, const glm::vec3 &extents)
+    {
+        glm::vec3 outside = glm::max(glm::abs(point - center) - extents, glm::vec3(0.0f));
+        return glm::dot(outside, outside);
+    };
+
+    std::vector<uint32_t> stack;
+    stack.push_back(0);
+    while (!stack.empty())
+    {
+        const Node &node = nodes[stack.back()];
+        stack.pop_back();
+        if (distanceSquared(node.bounds.getCenter(), node.bounds.getExtents()) > maxDistanceSquared)
+            continue;
+
+        if (node.leftChild)
+        {
+            stack.push_back(node.leftChild + 1);
+            stack.push_back(node.leftChild);
+            continue;
+        }
+
+        for (uint32_t slot = node.firstItem; slot < node.firstItem + node.itemCount; ++slot)
+        {
+            if (distanceSquared(itemCenters[slot], itemExtents[slot]) <= maxDistanceSquared)
+                out.push_back(itemIds[slot]);
+        }
+    }
+}
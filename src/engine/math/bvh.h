@@ -0,0 +1,74 @@
+/**
+ * @file bvh.h
+ * @brief Bounding volume hierarchy over boxes, for culling and proximity queries
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "bounds.h"
+#include "frustum.h"
+
+/**
+ * @brief Binary tree of boxes built with the surface area heuristic.
+ *
+ * Items are identified by their index in the arrays passed to build(). The tree keeps its
+ * own copy of their bounds, reordered so every node's items are one contiguous range;
+ * a node found entirely inside the frustum hands over its whole range without testing
+ * anything below it, so culling costs roughly the number of visible items plus the
+ * nodes along the frustum's edges, not the size of the tree.
+ *
+ * When items move without being added or removed, setItemBounds() then refit() updates
+ * the boxes bottom-up without changing the tree's shape. That is much cheaper than a
+ * build, but the tree gets looser as items drift from where they were at build time;
+ * getCost() against the cost right after the build tells when to rebuild.
+ */
+class Bvh
+{
+public:
+    static constexpr uint32_t MaxLeafSize = 4;
+
+    // Build from scratch. radii are of spheres around each box's centre, used by cull().
+    void build(const BoundingBox *boxes, const float *radii, size_t count);
+
+    void clear();
+
+    // New bounds for item, effective after the next refit()
+    void setItemBounds(uint32_t item, const BoundingBox &box, float radius);
+
+    // Recompute every node box from its items after setItemBounds calls
+    void refit();
+
+    // Expected cost of a query: the surface area of every node relative to the root's
+    float getCost() const;
+
+    // Append items whose box and sphere may intersect frustum
+    void cull(const Frustum &frustum, std::vector<uint32_t> &out) const;
+
+    // Append items whose box is within maxDistance of point
+    void queryDistance(const glm::vec3 &point, float maxDistance, std::vector<uint32_t> &out) const;
+
+    size_t size() const { return itemIds.size(); }
+    bool empty() const { return itemIds.empty(); }
+
+private:
+    struct Node
+    {
+        BoundingBox bounds;
+        uint32_t firstItem; // Range in the leaf-ordered arrays, for leaves and inner nodes alike
+        uint32_t itemCount;
+        uint32_t leftChild; // Right child is leftChild + 1; 0 for leaves (the root is never a child)
+    };
+
+    // Leaves hold at most MaxLeafSize items; larger ranges are always split
+    void buildNodes(uint32_t count, const BoundingBox *boxes);
+
+    std::vector<Node> nodes;              // Parents before children; nodes[0] is the root
+    std::vector<uint32_t> itemIds;        // Leaf order -> item
+    std::vector<uint32_t> itemSlots;      // Item -> leaf order
+    std::vector<glm::vec3> itemCenters;   // Leaf order, world-space box centre
+    std::vector<glm::vec3> itemExtents;   // Leaf order, half size
+    std::vector<float> itemRadii;         // Leaf order
+    std::vector<glm::vec3> buildCentroids; // Item order, only used while building
+};
@@ -0,0 +1,129 @@
+/**
+ * @file frustum.cpp
+ * @brief View frustum planes and batched visibility tests against them
+ */
+#include <cmath>
+#include "frustum.h"
+#include "simd.h"
+
+namespace
+{
+    bool visibleScalar(const Frustum &frustum, const glm::vec3 &center, const glm::vec3 &extents, float radius)
+    {
+        for (const glm::vec4 &plane : frustum.planes)
+        {
+            glm::vec3 normal(plane);
+            float distance = glm::dot(normal, center) + plane.w;
+            float boxRadius = glm::dot(glm::abs(normal), extents);
+            if (distance + boxRadius < 0.0f || distance + radius < 0.0f)
+                return false;
+        }
+        return true;
+    }
+
+#ifdef MATH_SSE
+    // Plane coefficients broadcast across lanes, done once per call
+    struct PlaneLanes
+    {
+        __m128 normal[3];
+        __m128 absNormal[3];
+        __m128 offset;
+    };
+#endif
+}
+
+Frustum Frustum::fromViewProjection(const glm::mat4 &m)
+{
+    // Gribb & Hartmann: each plane is the last row of the matrix plus or minus another row
+    auto row = [&m](int i) { return glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]); };
+
+    Frustum frustum;
+    frustum.planes[0] = row(3) + row(0);
+    frustum.planes[1] = row(3) - row(0);
+    frustum.planes[2] = row(3) + row(1);
+    frustum.planes[3] = row(3) - row(1);
+    frustum.planes[4] = row(3) + row(2);
+    frustum.planes[5] = row(3) - row(2);
+
+    for (glm::vec4 &plane : frustum.planes)
+    {
+        plane /= glm::length(glm::vec3(plane));
+    }
+    return frustum;
+}
+
+bool Frustum::intersects(const BoundingBox &box) const
+{
+    glm::vec3 center = box.getCenter();
+    glm::vec3 extents = box.getExtents();
+    for (const glm::vec4 &plane : planes)
+    {
+        glm::vec3 normal(plane);
+        if (glm::dot(normal, center) + plane.w + glm::dot(glm::abs(normal), extents) < 0.0f)
+            return false;
+    }
+    return true;
+}
+
+bool Frustum::intersects(const BoundingSphere &sphere) const
+{
+    for (const glm::vec4 &plane : planes)
+    {
+        if (glm::dot(glm::vec3(plane), sphere.center) + plane.w + sphere.radius < 0.0f)
+            return false;
+    }
+    return true;
+}
+
+void cullAgainstFrustum(const Frustum &frustum, const glm::vec3 *centers, const glm::vec3 *extents,
+                        const float *radii, size_t count, uint8_t *visible)
+{
+    size_t i = 0;
+
+#ifdef MATH_SSE
+    PlaneLanes planes[6];
+    for (int p = 0; p < 6; ++p)
+    {
+        const glm::vec4 &plane = frustum.planes[p];
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            planes[p].normal[axis] = _mm_set1_ps(plane[axis]);
+            planes[p].absNormal[axis] = _mm_set1_ps(std::abs(plane[axis]));
+        }
+        planes[p].offset = _mm_set1_ps(plane.w);
+    }
+
+    __m128 zero = _mm_setzero_ps();
+
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 c[3], e[3];
+        simd::loadVec3x4(centers + i, c);
+        simd::loadVec3x4(extents + i, e);
+        __m128 r = _mm_loadu_ps(radii + i);
+
+        __m128 outside = zero;
+        for (const PlaneLanes &plane : planes)
+        {
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(plane.normal[0], c[0]), _mm_mul_ps(plane.normal[1], c[1])),
+                                         _mm_add_ps(_mm_mul_ps(plane.normal[2], c[2]), plane.offset));
+            __m128 boxRadius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(plane.absNormal[0], e[0]), _mm_mul_ps(plane.absNormal[1], e[1])),
+                                          _mm_mul_ps(plane.absNormal[2], e[2]));
+
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, boxRadius), zero));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, r), zero));
+        }
+
+        int mask = _mm_movemask_ps(outside);
+        visible[i + 0] = (mask & 1) ? 0 : 1;
+        visible[i + 1] = (mask & 2) ? 0 : 1;
+        visible[i + 2] = (mask & 4) ? 0 : 1;
+        visible[i + 3] = (mask & 8) ? 0 : 1;
+    }
+#endif
+
+    for (; i < count; ++i)
+    {
+        visible[i] = visibleScalar(frustum, centers[i], extents[i], radii[i]) ? 1 : 0;
+    }
+}
@@ -0,0 +1,36 @@
+/**
+ * @file frustum.h
+ * @brief View frustum planes and batched visibility tests against them
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include "bounds.h"
+
+struct Frustum
+{
+    // Left, right, bottom, top, near, far. xyz is the unit normal pointing inside, w the
+    // offset, so a point p is inside a plane when dot(xyz, p) + w >= 0.
+    glm::vec4 planes[6];
+
+    // Planes of the clip volume of projection * view
+    static Frustum fromViewProjection(const glm::mat4 &viewProjection);
+
+    // False only if the box or sphere lies entirely outside one plane
+    bool intersects(const BoundingBox &box) const;
+    bool intersects(const BoundingSphere &sphere) const;
+};
+
+/**
+ * @brief Test count objects against the frustum at once.
+ *
+ * Each object is given by a world-space box (centre and half extents) and a sphere around
+ * the same centre. visible[i] is set to 1 if neither lies entirely outside a plane, else 0.
+ * Like the single tests this is conservative: objects near a frustum corner may pass.
+ *
+ * Uses SSE, four objects per step, on x86-64, with a scalar fallback elsewhere and for
+ * the leftover objects.
+ */
+void cullAgainstFrustum(const Frustum &frustum, const glm::vec3 *centers, const glm::vec3 *extents,
+                        const float *radii, size_t count, uint8_t *visible);
@@ -0,0 +1,34 @@
+/**
+ * @file simd.h
+ * @brief SSE helpers shared by the batched math kernels; internal to math/
+ */
+#pragma once
+#include <glm/glm.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MATH_SSE 1
+#include <xmmintrin.h>
+#endif
+
+#ifdef MATH_SSE
+namespace simd
+{
+    static_assert(sizeof(glm::vec3) == 3 * sizeof(float), "The SIMD loads expect tightly packed vec3s");
+
+    // Four packed vec3s, 12 floats: x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3, into one
+    // register per component, one vec3 per lane
+    inline void loadVec3x4(const glm::vec3 *source, __m128 (&out)[3])
+    {
+        const float *f = &source->x;
+        __m128 a = _mm_loadu_ps(f);
+        __m128 b = _mm_loadu_ps(f + 4);
+        __m128 c = _mm_loadu_ps(f + 8);
+
+        __m128 t1 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 1, 3, 2)); // x2 y2 x3 y3
+        __m128 t2 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 0, 2, 1)); // y0 z0 y1 z1
+        out[0] = _mm_shuffle_ps(a, t1, _MM_SHUFFLE(2, 0, 3, 0));
+        out[1] = _mm_shuffle_ps(t2, t1, _MM_SHUFFLE(3, 1, 2, 0));
+        out[2] = _mm_shuffle_ps(t2, c, _MM_SHUFFLE(3, 0, 3, 1));
+    }
+}
+#endif
@@ -0,0 +1,203 @@
+/**
+ * @file transform_kernel.cpp
+ * @brief Batched position/rotation/scale to matrix conversion
+ */
+#include "transform_kernel.h"
+#include "simd.h"
+
+namespace
+{
+    void composeScalar(const glm::vec3 &p, const glm::quat &q, const glm::vec3 &s, glm::mat4 &model, glm::mat3 *normal)
+    {
+        float x2 = q.x + q.x, y2 = q.y + q.y, z2 = q.z + q.z;
+        float xx = q.x * x2, yy = q.y * y2, zz = q.z * z2;
+        float xy = q.x * y2, xz = q.x * z2, yz = q.y * z2;
+        float wx = q.w * x2, wy = q.w * y2, wz = q.w * z2;
+
+        glm::vec3 axisX(1.0f - (yy + zz), xy + wz, xz - wy);
+        glm::vec3 axisY(xy - wz, 1.0f - (xx + zz), yz + wx);
+        glm::vec3 axisZ(xz + wy, yz - wx, 1.0f - (xx + yy));
+
+        model[0] = glm::vec4(axisX * s.x, 0.0f);
+        model[1] = glm::vec4(axisY * s.y, 0.0f);
+        model[2] = glm::vec4(axisZ * s.z, 0.0f);
+        model[3] = glm::vec4(p, 1.0f);
+
+        if (normal)
+        {
+            (*normal)[0] = axisX / s.x;
+            (*normal)[1] = axisY / s.y;
+            (*normal)[2] = axisZ / s.z;
+        }
+    }
+
+#ifdef MATH_SSE
+    static_assert(sizeof(glm::quat) == 4 * sizeof(float), "The SIMD loads expect tightly packed quats");
+    static_assert(sizeof(glm::mat4) == 16 * sizeof(float) && sizeof(glm::mat3) == 9 * sizeof(float),
+                  "The SIMD stores expect tightly packed matrices");
+
+    // Short names keep the quaternion math below readable
+    inline __m128 add(__m128 a, __m128 b) { return _mm_add_ps(a, b); }
+    inline __m128 sub(__m128 a, __m128 b) { return _mm_sub_ps(a, b); }
+    inline __m128 mul(__m128 a, __m128 b) { return _mm_mul_ps(a, b); }
+    inline __m128 div(__m128 a, __m128 b) { return _mm_div_ps(a, b); }
+
+    // One register per component, one object per lane
+    struct Lanes
+    {
+        __m128 p[3];
+        __m128 q[4]; // x, y, z, w
+        __m128 s[3];
+    };
+
+    // Columns of the model and normal matrices' upper 3x3, per lane
+    struct Basis
+    {
+        __m128 model[3][3];
+        __m128 normal[3][3];
+    };
+
+    void computeBasis(const Lanes &in, Basis &out, bool withNormals)
+    {
+        const __m128 &x = in.q[0], &y = in.q[1], &z = in.q[2], &w = in.q[3];
+        __m128 one = _mm_set1_ps(1.0f);
+
+        __m128 x2 = add(x, x), y2 = add(y, y), z2 = add(z, z);
+        __m128 xx = mul(x, x2), yy = mul(y, y2), zz = mul(z, z2);
+        __m128 xy = mul(x, y2), xz = mul(x, z2), yz = mul(y, z2);
+        __m128 wx = mul(w, x2), wy = mul(w, y2), wz = mul(w, z2);
+
+        __m128 rotation[3][3] = {
+            {sub(one, add(yy, zz)), add(xy, wz), sub(xz, wy)},
+            {sub(xy, wz), sub(one, add(xx, zz)), add(yz, wx)},
+            {add(xz, wy), sub(yz, wx), sub(one, add(xx, yy))}};
+
+        for (int column = 0; column < 3; ++column)
+        {
+            __m128 inverseScale;
+            if (withNormals)
+            {
+                inverseScale = div(one, in.s[column]);
+            }
+            for (int row = 0; row < 3; ++row)
+            {
+                out.model[column][row] = mul(rotation[column][row], in.s[column]);
+                if (withNormals)
+                {
+                    out.normal[column][row] = mul(rotation[column][row], inverseScale);
+                }
+            }
+        }
+    }
+
+    void loadLanes(const glm::vec3 *positions, const glm::quat *rotations, const glm::vec3 *scales, Lanes &out)
+    {
+        simd::loadVec3x4(positions, out.p);
+        simd::loadVec3x4(scales, out.s);
+
+        __m128 r0 = _mm_loadu_ps(&rotations[0][0]);
+        __m128 r1 = _mm_loadu_ps(&rotations[1][0]);
+        __m128 r2 = _mm_loadu_ps(&rotations[2][0]);
+        __m128 r3 = _mm_loadu_ps(&rotations[3][0]);
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+#ifdef GLM_FORCE_QUAT_DATA_WXYZ
+        out.q[3] = r0;
+        out.q[0] = r1;
+        out.q[1] = r2;
+        out.q[2] = r3;
+#else
+        out.q[0] = r0;
+        out.q[1] = r1;
+        out.q[2] = r2;
+        out.q[3] = r3;
+#endif
+    }
+
+    void storeLanes(const Lanes &in, const Basis &basis, glm::mat4 *models, glm::mat3 *normals)
+    {
+        __m128 zero = _mm_setzero_ps();
+        __m128 one = _mm_set1_ps(1.0f);
+
+        // Transposing (x, y, z, w) lanes gives one matrix column per object
+        for (int column = 0; column < 4; ++column)
+        {
+            __m128 c0, c1, c2, c3;
+            if (column < 3)
+            {
+                c0 = basis.model[column][0];
+                c1 = basis.model[column][1];
+                c2 = basis.model[column][2];
+                c3 = zero;
+            }
+            else
+            {
+                c0 = in.p[0];
+                c1 = in.p[1];
+                c2 = in.p[2];
+                c3 = one;
+            }
+            _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+            _mm_storeu_ps(&models[0][column][0], c0);
+            _mm_storeu_ps(&models[1][column][0], c1);
+            _mm_storeu_ps(&models[2][column][0], c2);
+            _mm_storeu_ps(&models[3][column][0], c3);
+        }
+
+        if (!normals)
+            return;
+
+        for (int column = 0; column < 3; ++column)
+        {
+            __m128 c[4] = {basis.normal[column][0], basis.normal[column][1], basis.normal[column][2], zero};
+            _MM_TRANSPOSE4_PS(c[0], c[1], c[2], c[3]);
+            for (int object = 0; object < 4; ++object)
+            {
+                // A 4-wide store would run into the next column; columns are written in
+                // order so that's harmless, except for the last one
+                float *destination = &normals[object][column][0];
+                if (column < 2)
+                {
+                    _mm_storeu_ps(destination, c[object]);
+                }
+                else
+                {
+                    _mm_storel_pi(reinterpret_cast<__m64 *>(destination), c[object]);
+                    _mm_store_ss(destination + 2, _mm_movehl_ps(c[object], c[object]));
+                }
+            }
+        }
+    }
+#endif
+}
+
+void composeTransforms(const glm::vec3 *positions, const glm::quat *rotations, const glm::vec3 *scales,
+                       size_t count, glm::mat4 *models, glm::mat3 *normals)
+{
+    size_t i = 0;
+    bool withNormals = normals != nullptr;
+
+#ifdef MATH_SSE
+    for (; i + 4 <= count; i += 4)
+    {
+        Lanes lanes;
+        loadLanes(positions + i, rotations + i, scales + i, lanes);
+
+        Basis basis;
+        computeBasis(lanes, basis, withNormals);
+        storeLanes(lanes, basis, models + i, withNormals ? normals + i : nullptr);
+    }
+#endif
+
+    for (; i < count; ++i)
+    {
+        composeScalar(positions[i], rotations[i], scales[i], models[i], withNormals ? normals + i : nullptr);
+    }
+}
+
+glm::mat4 composeTransform(const glm::vec3 &position, const glm::quat &rotation, const glm::vec3 &scale)
+{
+    glm::mat4 model;
+    composeScalar(position, rotation, scale, model, nullptr);
+    return model;
+}
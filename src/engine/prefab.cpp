@@ -0,0 +1,135 @@
+/**
+ * @file prefab.cpp
+ * @brief Reusable GameObject templates that scenes can spawn many copies of
+ */
+#include <cctype>
+#include <fstream>
+#include <iomanip>
+#include "prefab.h"
+#include "gameobject.h"
+#include "../helpers/logging.h"
+
+namespace
+{
+    // "Enemy (12)" -> "Enemy": the id suffix belongs to the object the prefab was made from
+    std::string stripIdSuffix(const std::string &name)
+    {
+        size_t open = name.rfind(" (");
+        if (open == std::string::npos || name.back() != ')' || open + 3 > name.size() - 1)
+            return name;
+
+        for (size_t i = open + 2; i < name.size() - 1; ++i)
+        {
+            if (!std::isdigit(static_cast<unsigned char>(name[i])))
+                return name;
+        }
+        return name.substr(0, open);
+    }
+}
+
+std::shared_ptr<Prefab> Prefab::fromGameObject(const GameObject &gameObject)
+{
+    json j;
+    gameObject.serialize(j);
+
+    auto prefab = std::make_shared<Prefab>();
+    prefab->load(j);
+    return prefab;
+}
+
+void Prefab::load(const json &j)
+{
+    registry.destroy(entity);
+    entity = registry.create();
+    components.clear();
+    transformPrototype = nullptr;
+
+    name = stripIdSuffix(j.value("name", std::string("Prefab")));
+    isStatic = j.value("isStatic", false);
+    active = j.value("isActive", true);
+
+    for (const auto &componentJson : j["components"])
+    {
+        const std::string &typeName = componentJson["type"].get_ref<const std::string &>();
+        const ComponentType *type = ComponentFactory::getInstance().find(typeName);
+        if (!type)
+        {
+            LOG_WARNING("Prefab {} skips unknown component type {}", name, typeName);
+            continue;
+        }
+
+        Component *prototype = type->create(registry, entity);
+        prototype->deserialize(componentJson);
+
+        if (type->id == componentTypeId<TransformComponent>())
+        {
+            transformPrototype = static_cast<const TransformComponent *>(prototype);
+            continue;
+        }
+        components.push_back({type, prototype});
+    }
+
+    if (!transformPrototype)
+    {
+        transformPrototype = registry.emplace<TransformComponent>(entity);
+    }
+    transform.position = transformPrototype->getPosition();
+    transform.rotation = transformPrototype->getRotation();
+    transform.scale = transformPrototype->getScale();
+}
+
+void Prefab::save(json &j) const
+{
+    j["name"] = name;
+    j["isStatic"] = isStatic;
+    j["isActive"] = active;
+
+    json componentsArray = json::array();
+    json transformJson;
+    transformPrototype->serialize(transformJson);
+    componentsArray.push_back(transformJson);
+    for (const Entry &entry : components)
+    {
+        json componentJson;
+        entry.prototype->serialize(componentJson);
+        componentsArray.push_back(componentJson);
+    }
+    j["components"] = componentsArray;
+}
+
+bool Prefab::loadFromFile(const std::string &path)
+{
+    try
+    {
+        std::ifstream file(path);
+        if (!file.is_open())
+        {
+            LOG_ERROR("Failed to open prefab for reading: {}", path);
+            return false;
+        }
+
+        json j;
+        file >> j;
+        load(j);
+        return true;
+    }
+    catch (const std::exception &e)
+    {
+        LOG_ERROR("Failed to load prefab {}: {}", path, e.what());
+        return false;
+    }
+}
+
+void Prefab::saveToFile(const std::string &path) const
+{
+    json j;
+    save(j);
+
+    std::ofstream file(path);
+    if (!file.is_open())
+    {
+        LOG_ERROR("Failed to open prefab for writing: {}", path);
+        return;
+    }
+    file << std::setw(4) << j << std::endl;
+}
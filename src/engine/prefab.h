@@ -0,0 +1,82 @@
+/**
+ * @file prefab.h
+ * @brief Reusable GameObject templates that scenes can spawn many copies of
+ */
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include "component_factory.h"
+#include "components/transform_component.h"
+#include "ecs/entity_registry.h"
+#include "serialization.h"
+
+class GameObject;
+
+// Placement of one prefab instance, relative to its parent (or the world for roots)
+struct InstanceTransform
+{
+    glm::vec3 position{0.0f};
+    glm::quat rotation{1.0f, 0.0f, 0.0f, 0.0f};
+    glm::vec3 scale{1.0f};
+};
+
+/**
+ * @brief A GameObject template, stored in the same format GameObject::serialize writes.
+ *
+ * Loading parses the data once into prototype components that the prefab owns. Scene::
+ * instantiate copies those prototypes into each instance, so spawning never touches
+ * JSON. Assets such as meshes are held by shared_ptr and stay shared by every instance
+ * until an instance assigns a different one. The prototypes are read-only: editing an
+ * instance never changes the prefab or the other instances.
+ *
+ * Only the object itself is captured, not its children.
+ */
+class Prefab
+{
+public:
+    struct Entry
+    {
+        const ComponentType *type;
+        const Component *prototype;
+    };
+
+    Prefab() : entity(registry.create())
+    {
+        transformPrototype = registry.emplace<TransformComponent>(entity);
+    }
+
+    Prefab(const Prefab &) = delete;
+    Prefab &operator=(const Prefab &) = delete;
+
+    // Snapshot of an existing object, e.g. one set up in the editor
+    static std::shared_ptr<Prefab> fromGameObject(const GameObject &gameObject);
+
+    // Read data in GameObject::serialize's format; ids and parents are ignored
+    void load(const json &j);
+    void save(json &j) const;
+
+    bool loadFromFile(const std::string &path);
+    void saveToFile(const std::string &path) const;
+
+    const std::string &getName() const { return name; }
+    bool getIsStatic() const { return isStatic; }
+    bool getIsActive() const { return active; }
+
+    const InstanceTransform &getTransform() const { return transform; }
+
+    // Every component except the transform, in the order the source object had them
+    const std::vector<Entry> &getComponents() const { return components; }
+
+private:
+    std::string name = "Prefab";
+    bool isStatic = false;
+    bool active = true;
+    InstanceTransform transform;
+    EntityRegistry registry; // Owns the prototypes
+    Entity entity;
+    const TransformComponent *transformPrototype = nullptr;
+    std::vector<Entry> components;
+};
@@ -10,112 +10,332 @@
 #include "components/meshrenderer.h"
 #include "components/script_component.h"
 #include "scene.h"
+#include "systems/component_update_system.h"
+#include "systems/first_person_controller_system.h"
+#include "systems/script_system.h"
+#include "jobs/job_system.h"
 #include "../helpers/logging.h"
 #include <json/json.hpp>
 
-void Scene::render(Shader &shader, GameObject *selectedObject)
+void Scene::render(Shader &shader, const FrameUniforms &camera, Shader *instancedShader)
 {
-    // First collect and apply all lights
-    std::vector<Light *> lights;
-    for (const auto &gameObject : gameObjects)
-    {
-        if (!gameObject || !gameObject->isActive)
-            continue;
+    updateRenderBvh();
 
-        if (auto light = gameObject->getComponent<Light>())
-        {
-            lights.push_back(light);
-        }
-    }
+    // Camera and main light go to every shader at once through the Frame block
+    const std::vector<Light*>& lights = active<Light>();
+    Light *mainLight = lights.empty() ? nullptr : lights.front();
 
-    // Apply light properties
-    if (!lights.empty())
+    FrameUniforms frame = camera;
+    if (mainLight)
     {
-        auto mainLight = lights[0];
-        shader.setVec3("lightPos", mainLight->getOwner()->getPosition());
-        shader.setVec3("lightColor", mainLight->getColor() * mainLight->getIntensity());
+        frame.lightPos = glm::vec4(mainLight->getPosition(), 1.0f);
+        frame.lightColor = glm::vec4(mainLight->getColor() * mainLight->getIntensity(), 1.0f);
     }
     else
     {
         // Default light if no lights in scene
-        shader.setVec3("lightPos", glm::vec3(2.0f, 2.0f, 2.0f));
-        shader.setVec3("lightColor", glm::vec3(1.0f));
+        frame.lightPos = glm::vec4(2.0f, 2.0f, 2.0f, 1.0f);
+        frame.lightColor = glm::vec4(1.0f);
     }
+    renderQueue.setFrame(frame);
+    glm::vec3 viewPosition(camera.viewPos);
 
-    // Render all objects
-    for (const auto &gameObject : gameObjects)
-    {
-        if (!gameObject || !gameObject->isActive)
+    // Queue the meshes in view, then draw them sorted by shader, mesh and colour, nearest first
+    glm::mat4 viewProjection = camera.projection * camera.view;
+    visibleRenderers.clear();
+    renderBvh.cull(Frustum::fromViewProjection(viewProjection), visibleRenderers);
+    if (occlusionCulling) {
+        cullOccludedRenderers(viewProjection);
+    }
+
+    renderQueue.setInstancing(&shader, instancedShader);
+    renderQueue.clear();
+    for (MeshRenderer* renderer : visibleRenderers) {
+        const Mesh* mesh = renderer->getMeshPtr();
+        if (!mesh)
             continue;
+        const TransformComponent* transform = renderer->getOwner()->getTransform();
+        glm::vec3 offset = transform->getWorldPosition() - viewPosition;
+        renderQueue.submit(RenderPass::Opaque, shader, *mesh, transform->getWorldMatrix(),
+                           transform->getNormalMatrix(), renderer->getColor(), glm::dot(offset, offset));
+    }
+    renderQueue.sort();
+    renderQueue.execute();
+
+    // Any other component types that draw something
+    for (const ComponentType* type : renderHooks) {
+        type->render(registry, shader);
+    }
+}
 
-        // Set model matrix from TransformComponent
-        shader.setMat4("model", gameObject->getModelMatrix());
+std::vector<GameObject *> Scene::instantiate(const Prefab &prefab, size_t count, const InstanceTransform *transforms)
+{
+    std::vector<GameObject *> instances;
+    instances.reserve(count);
+    gameObjects.reserve(gameObjects.size() + count);
+
+    const InstanceTransform &defaultTransform = prefab.getTransform();
+    for (size_t i = 0; i < count; ++i)
+    {
+        GameObject *gameObject = spawn(prefab.getName(), false);
+        gameObject->isStatic = prefab.getIsStatic();
+        gameObject->setActive(prefab.getIsActive());
 
-        // Render all components
-        for (const auto &component : gameObject->getAllComponents())
+        const InstanceTransform &transform = transforms ? transforms[i] : defaultTransform;
+        gameObject->getTransform()->setLocal(transform.position, transform.rotation, transform.scale);
+
+        for (const Prefab::Entry &entry : prefab.getComponents())
         {
-            if (component && component->isEnabled())
-            {
-                component->Render(shader);
-            }
+            Component *component = entry.type->clone(registry, gameObject->entity, *entry.prototype);
+            gameObject->attachComponent(component, entry.type->id);
         }
+        instances.push_back(gameObject);
     }
+    return instances;
+}
 
-    // After rendering all objects, handle gizmo manipulation for selected object
-    if (selectedObject)
-    {
-        if (auto transform = selectedObject->getTransform())
-        {
-            // Get current view/projection matrices
-            // TODO: Replace with proper camera system
-            glm::mat4 view = glm::lookAt(glm::vec3(0, 5, 10), glm::vec3(0), glm::vec3(0, 1, 0));
-            float aspectRatio = ImGui::GetIO().DisplaySize.x / ImGui::GetIO().DisplaySize.y;
-            glm::mat4 proj = glm::perspective(glm::radians(45.0f), aspectRatio, 0.1f, 1000.0f);
+void Scene::updateRenderBvh()
+{
+    updateWorldTransforms();
+    const std::vector<MeshRenderer*>& renderers = active<MeshRenderer>();
+    renderBvh.update(renderers, registry.activeVersion<MeshRenderer>(), transformHierarchy);
+    transformHierarchy.clearMoved();
+}
 
-            // Begin ImGuizmo frame
-            ImGuizmo::BeginFrame();
+void Scene::cullOccludedRenderers(const glm::mat4 &viewProjection)
+{
+    occlusionBuffer.begin(viewProjection);
+    bool anyOccluders = false;
+    for (MeshRenderer* renderer : visibleRenderers) {
+        const Mesh* mesh = renderer->getMeshPtr();
+        if (renderer->isOccluder() && mesh) {
+            occlusionBuffer.rasterize(*mesh, renderer->getOwner()->getTransform()->getWorldMatrix());
+            anyOccluders = true;
+        }
+    }
+    if (!anyOccluders)
+        return;
+    occlusionBuffer.finish();
 
-            // Set the viewport for ImGuizmo (should match your rendering viewport)
-            ImGuizmo::SetRect(0, 0, ImGui::GetIO().DisplaySize.x, ImGui::GetIO().DisplaySize.y);
+    // Occluders are always drawn. The tests only read the buffer, so batches run on any thread.
+    size_t count = visibleRenderers.size();
+    occlusionVisible.resize(count);
+    auto testRange = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const MeshRenderer* renderer = visibleRenderers[i];
+            const Mesh* mesh = renderer->getMeshPtr();
+            occlusionVisible[i] = mesh && (renderer->isOccluder() ||
+                                           occlusionBuffer.isVisible(mesh->getBounds().transformed(
+                                               renderer->getOwner()->getTransform()->getWorldMatrix())));
+        }
+    };
 
-            // Set orthographic mode based on camera
-            ImGuizmo::SetOrthographic(false);
+    if (count < OcclusionParallelThreshold) {
+        testRange(0, count);
+    } else {
+        Jobs().wait(Jobs().parallelFor(count, OcclusionBatchSize, testRange));
+    }
 
-            // Manipulate transform
-            transform->manipulateTransform(view, proj);
-        }
+    size_t kept = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (occlusionVisible[i])
+            visibleRenderers[kept++] = visibleRenderers[i];
     }
+    visibleRenderers.resize(kept);
+}
+
+void Scene::findMeshRenderersNear(const glm::vec3 &point, float radius, std::vector<MeshRenderer *> &out)
+{
+    updateRenderBvh();
+    renderBvh.queryDistance(point, radius, out);
 }
 
 void Scene::update(float deltaTime)
 {
-    for (const auto &gameObject : gameObjects)
+    systems.update(*this, deltaTime);
+
+    // Events first: they may point at objects that pending removals would destroy, and
+    // handlers can record commands of their own to be applied right after
+    dispatchEvents();
+    flushCommands();
+}
+
+void Scene::flushCommands()
+{
+    // Buffers are applied in thread order, each in the order it was recorded, then the
+    // shared one. A command may record further commands; those are applied in the same flush.
+    auto apply = [this](CommandBuffer &buffer)
     {
-        if (gameObject && gameObject->isActive)
+        if (buffer.empty())
+            return false;
+
+        buffer.swap(flushing);
+        applyCommands(flushing);
+        flushing.clear();
+        return true;
+    };
+
+    bool applied = true;
+    while (applied)
+    {
+        applied = false;
+        for (auto &buffer : commandBuffers)
         {
-            // Update all components
-            gameObject->update(deltaTime);
+            applied |= apply(*buffer);
+        }
+        applied |= apply(sharedCommands);
+    }
 
-            // If the object has a script, call OnUpdate
-            // TODO: What happens if the script is disabled, or if there are multiple scripts?
-            if (auto script = gameObject->getComponent<ScriptComponent>())
+    resizeThreadQueues();
+}
+
+void Scene::applyCommands(const std::vector<CommandBuffer::Command> &commands)
+{
+    for (const CommandBuffer::Command &command : commands)
+    {
+        switch (command.kind)
+        {
+        case CommandBuffer::Command::Kind::Create:
+        {
+            GameObject *gameObject = createGameObject(command.name);
+            if (command.apply)
+            {
+                command.apply(*gameObject);
+            }
+            break;
+        }
+        case CommandBuffer::Command::Kind::Remove:
+            removeGameObject(command.target);
+            break;
+        case CommandBuffer::Command::Kind::Modify:
+            // Skipped if an earlier command already removed the object
+            if (GameObject *gameObject = resolve(command.target))
             {
-                script->Update(deltaTime);
+                command.apply(*gameObject);
             }
+            break;
         }
     }
 }
 
-void Scene::clearScene()
+void Scene::resizeThreadQueues()
+{
+    size_t threadCount = std::max(1u, Jobs().getThreadCount());
+    while (commandBuffers.size() < threadCount)
+    {
+        commandBuffers.push_back(std::make_unique<CommandBuffer>());
+    }
+    eventBus.setThreadCount(threadCount);
+}
+
+void Scene::registerDefaultSystems()
+{
+    // Both write transforms, so the controller runs after scripts rather than alongside
+    systems.addSystem<ScriptSystem>();
+    systems.addSystem<FirstPersonControllerSystem>();
+
+    // Component types with an Update hook that no system above dispatches. Types that
+    // leave Update empty never get visited at all.
+    ComponentMask dispatched;
+    for (const auto& system : systems.getSystems()) {
+        dispatched |= system->getUpdates();
+    }
+
+    std::vector<const ComponentType*> updateHooks;
+    ComponentFactory::getInstance().each([&](const ComponentType& type) {
+        if (type.update && !dispatched.test(type.id)) {
+            updateHooks.push_back(&type);
+        }
+        if (type.render) {
+            renderHooks.push_back(&type);
+        }
+    });
+
+    if (!updateHooks.empty()) {
+        systems.addSystem<ComponentUpdateSystem>(std::move(updateHooks));
+    }
+}
+
+bool Scene::setParent(GameObject *child, GameObject *parent, bool keepWorldTransform)
 {
-    for (auto &gameObject : gameObjects)
+    if (!child || child->parent == parent)
+        return true;
+
+    for (GameObject *ancestor = parent; ancestor; ancestor = ancestor->parent)
     {
-        if (gameObject)
+        if (ancestor == child)
         {
-            gameObject->clearComponents();
+            LOG_WARNING("Can't parent {} to its own descendant {}", child->name, parent->name);
+            return false;
         }
     }
+
+    if (keepWorldTransform)
+    {
+        updateWorldTransforms();
+        glm::mat4 local = child->getTransform()->getWorldMatrix();
+        if (parent)
+        {
+            local = glm::inverse(parent->getTransform()->getWorldMatrix()) * local;
+        }
+
+        glm::vec3 position, scale, skew;
+        glm::quat rotation;
+        glm::vec4 perspective;
+        if (glm::decompose(local, scale, rotation, position, skew, perspective))
+        {
+            child->getTransform()->setLocal(position, glm::normalize(rotation), scale);
+        }
+    }
+
+    detachFromParent(child);
+    if (parent)
+    {
+        child->parent = parent;
+        parent->children.push_back(child);
+    }
+    transformHierarchy.markDirty();
+    return true;
+}
+
+void Scene::detachFromParent(GameObject *gameObject)
+{
+    GameObject *parent = gameObject->parent;
+    if (!parent)
+        return;
+
+    auto &siblings = parent->children;
+    siblings.erase(std::find(siblings.begin(), siblings.end(), gameObject));
+    gameObject->parent = nullptr;
+}
+
+void Scene::clearScene()
+{
+    // Invalidate every outstanding handle before the slots get reused
+    for (GameObject *gameObject : gameObjects)
+    {
+        ++slots[gameObject->getHandle().index].generation;
+    }
     gameObjects.clear();
+    idIndex.clear();
+    nameIndex.clear();
+    transformHierarchy.markDirty();
+    renderBvh.clear();
+    ++resetCount;
+
+    // Pending commands belong to the scene that is being thrown away
+    for (auto &buffer : commandBuffers)
+    {
+        buffer->clear();
+    }
+    sharedCommands.clear();
+    eventBus.clear();
+
+    // Bulk release: each component pool is torn down in one linear pass, then the
+    // objects themselves. Their entities are already gone, so no per-object cleanup
+    // runs, and the pages are kept for the next scene that gets loaded.
+    registry.clear();
+    objectPool.clear();
 }
 
 void Scene::saveToFile(const std::string &path)
@@ -3,53 +3,151 @@
 #include <vector>
 #include <string>
 #include <algorithm>
+#include <unordered_map>
 #include "../helpers/logging.h"
 #include "gameobject.h"
+#include "command_buffer.h"
+#include "events/event_bus.h"
+#include "prefab.h"
+#include "transform_hierarchy.h"
+#include "ecs/entity_registry.h"
+#include "ecs/slab_pool.h"
+#include "systems/system_scheduler.h"
 #include "components/light.h"
 #include "components/meshrenderer.h"
+#include "math/frustum.h"
+#include "scene_bvh.h"
+#include "../renderer/occlusion_buffer.h"
+#include "../renderer/render_queue.h"
 #include "../renderer/shader.h"
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
-#include <imgui.h>
-#include "ImGuizmo/ImGuizmo.h"
 #include <fstream>
 #include "serialization.h"
 #include <json/json.hpp> // Assuming you have a json library
 
 class Scene : public ISerializable {
 public:
-    Scene(const std::string& name = "New Scene") : name(name), isPlaying(false) {}
+    Scene(const std::string& name = "New Scene")
+        : name(name), eventBus(std::max(1u, Jobs().getThreadCount())), isPlaying(false) {
+        registerDefaultSystems();
+        resizeThreadQueues();
+    }
     ~Scene() {
         clearScene();
     }
 
     GameObject* createGameObject(const std::string& name = "GameObject") {
-        auto gameObject = std::make_unique<GameObject>(name);
-        auto ptr = gameObject.get();
-        gameObjects.push_back(std::move(gameObject));
-        return ptr;
+        return spawn(name, true);
+    }
+
+    /**
+     * @brief Spawn count copies of a prefab in one go.
+     * @param transforms count local transforms, one per instance, or nullptr to use the prefab's own.
+     * @return The new objects, in order.
+     *
+     * Components are copied from the prefab's prototypes instead of being deserialized
+     * one by one, and instances share the prefab's name rather than getting "name (id)".
+     * Not safe while iterating the scene; wrap it in a commands().modify or do it between frames.
+     */
+    std::vector<GameObject*> instantiate(const Prefab& prefab, size_t count = 1, const InstanceTransform* transforms = nullptr);
+
+    // O(1) per object: the last object is swapped into the removed one's place, so order is
+    // not preserved. Children are removed along with their parent.
+    // Not safe while iterating the scene; record the removal with commands() instead.
+    void removeGameObject(GameObjectHandle handle) {
+        GameObject* gameObject = resolve(handle);
+        if (!gameObject)
+            return;
+
+        while (!gameObject->children.empty()) {
+            removeGameObject(gameObject->children.back()->getHandle());
+        }
+        detachFromParent(gameObject);
+        transformHierarchy.markDirty();
+
+        removeFromIndexes(gameObject);
+
+        uint32_t denseIndex = slots[handle.index].denseIndex;
+        GameObject* last = gameObjects.back();
+        gameObjects[denseIndex] = last;
+        slots[last->getHandle().index].denseIndex = denseIndex;
+        gameObjects.pop_back();
+
+        ++slots[handle.index].generation;  // Invalidates every outstanding handle
+        objectPool.destroy(handle.index);  // Releases the entity and its components
     }
 
     void removeGameObject(GameObject* gameObject) {
-        auto it = std::find_if(gameObjects.begin(), gameObjects.end(),
-            [gameObject](const std::unique_ptr<GameObject>& obj) {
-                return obj.get() == gameObject;
-            });
-
-        if (it != gameObjects.end()) {
-            (*it)->clearComponents();  // Clear components first
-            gameObjects.erase(it);
+        if (gameObject) {
+            removeGameObject(gameObject->getHandle());
         }
     }
 
+    // Returns null if the object has been removed since the handle was taken
+    GameObject* resolve(GameObjectHandle handle) {
+        if (handle.index >= slots.size() || slots[handle.index].generation != handle.generation)
+            return nullptr;
+        return objectPool.occupied(handle.index) ? objectPool.at(handle.index) : nullptr;
+    }
+
+    /**
+     * @brief Move an object under a new parent, or to the root if parent is null.
+     * @param keepWorldTransform Adjust the local transform so the object stays where it is.
+     * @return False if parent is the object itself or one of its descendants.
+     */
+    bool setParent(GameObject* child, GameObject* parent, bool keepWorldTransform = true);
+
+    // Brings every world matrix up to date; render() calls this first
+    void updateWorldTransforms() { transformHierarchy.update(gameObjects); }
+
+    // Keeps the name index in sync; assign names through this rather than directly
+    void renameGameObject(GameObject* gameObject, const std::string& newName) {
+        removeFromIndexes(gameObject);
+        gameObject->name = newName;
+        addToIndexes(gameObject);
+    }
+
     void clearScene();  // Definition moved to cpp file
 
-    const std::vector<std::unique_ptr<GameObject>>& getAllGameObjects() const {
+    // Bumped by clearScene, so holders of handles can tell they have all gone stale
+    uint64_t getResetCount() const { return resetCount; }
+
+    // Command buffer of the calling thread, for structural changes made during iteration.
+    // Threads outside the job system, or workers added since the last flush, get the shared one.
+    CommandBuffer& commands() {
+        int threadIndex = JobSystem::getThreadIndex();
+        if (threadIndex < 0 || static_cast<size_t>(threadIndex) >= commandBuffers.size())
+            return sharedCommands;
+        return *commandBuffers[threadIndex];
+    }
+
+    // Sync point: applies every recorded command, main thread only
+    void flushCommands();
+
+    // Events posted by components and systems; post() is safe from any job thread
+    EventBus& events() { return eventBus; }
+
+    // Sync point: delivers every posted event, main thread only
+    void dispatchEvents() { eventBus.dispatch(); }
+
+    const std::vector<GameObject*>& getAllGameObjects() const {
         return gameObjects;
     }
 
-    void render(Shader& shader, GameObject* selectedObject = nullptr);
-    void update(float deltaTime);
+    // camera supplies view, projection and viewPos; the scene adds its light. Meshes drawn
+    // several times with shader go through instancedShader in one call each, if given.
+    void render(Shader& shader, const FrameUniforms& camera, Shader* instancedShader = nullptr);
+    void update(float deltaTime);  // Runs every system once, then dispatches events and flushes commands
+
+    // Skip meshes hidden behind occluder meshes in view; only costs anything when some are
+    void setOcclusionCulling(bool enabled) { occlusionCulling = enabled; }
+    bool getOcclusionCulling() const { return occlusionCulling; }
+
+    // Append the mesh renderers whose world bounds come within radius of point
+    void findMeshRenderersNear(const glm::vec3& point, float radius, std::vector<MeshRenderer*>& out);
+
+    SystemScheduler& getSystems() { return systems; }
 
     // Serialization
     void serialize(json& j) const override {
@@ -74,10 +172,27 @@ public:
         
         // Deserialize game objects
         const auto& objectsArray = j.at("gameObjects");
+        std::vector<std::pair<GameObject*, uint64_t>> parentLinks;
         for (const auto& objectJson : objectsArray) {
-            auto gameObject = std::make_unique<GameObject>();
+            GameObject* gameObject = createGameObject();
+            removeFromIndexes(gameObject);
             gameObject->deserialize(objectJson);
-            gameObjects.push_back(std::move(gameObject));
+            addToIndexes(gameObject);
+
+            if (objectJson.contains("parent")) {
+                parentLinks.emplace_back(gameObject, objectJson["parent"].get<uint64_t>());
+            }
+        }
+
+        // Parents may come after their children in the file, so link once all exist.
+        // Saved transforms are already local to the parent.
+        for (const auto& [child, parentId] : parentLinks) {
+            GameObject* parent = findGameObjectById(parentId);
+            if (!parent) {
+                LOG_WARNING("Parent {} of {} not found, keeping it at the root", parentId, child->name);
+                continue;
+            }
+            setParent(child, parent, false);
         }
     }
 
@@ -86,28 +201,108 @@ public:
     bool loadFromFile(const std::string& path);
 
     GameObject* findGameObjectById(uint64_t id) {
-        auto it = std::find_if(gameObjects.begin(), gameObjects.end(),
-            [id](const std::unique_ptr<GameObject>& obj) {
-                return obj && obj->id == id;  // Check for null
-            });
-
-        return it != gameObjects.end() ? it->get() : nullptr;
+        auto it = idIndex.find(id);
+        return it != idIndex.end() ? objectPool.at(it->second) : nullptr;
     }
 
     GameObject* findGameObjectByName(const std::string& name) {
-        auto it = std::find_if(gameObjects.begin(), gameObjects.end(),
-            [&name](const std::unique_ptr<GameObject>& obj) {
-                return obj && obj->name == name;  // Check for null
-            });
-
-        return it != gameObjects.end() ? it->get() : nullptr;
+        auto it = nameIndex.find(name);
+        return it != nameIndex.end() ? objectPool.at(it->second) : nullptr;
     }
 
     void setPlayMode(bool playing) { isPlaying = playing; }
     bool getPlayMode() const { return isPlaying; }
 
+    EntityRegistry& getRegistry() { return registry; }
+
+    // Entities that have every listed component, e.g. view<TransformComponent, MeshRenderer>()
+    template <typename... Ts>
+    View<Ts...> view() { return registry.view<Ts...>(); }
+
+    // Enabled components of type T on active objects, the ones whose hooks should run
+    template <typename T>
+    const std::vector<T*>& active() { return registry.active<T>(); }
+
 private:
+    friend class SceneSnapshot;
+
+    static constexpr size_t OcclusionParallelThreshold = 1024;  // Fewer candidates are tested inline
+    static constexpr size_t OcclusionBatchSize = 256;
+
+    void registerDefaultSystems();
+    void detachFromParent(GameObject* gameObject);
+    void resizeThreadQueues();  // A command buffer and event queue per job thread, grown at sync points
+    void applyCommands(const std::vector<CommandBuffer::Command>& commands);
+
+    // Bring world transforms and the BVH up to date with the active mesh renderers
+    void updateRenderBvh();
+
+    // Rasterize the occluders among visibleRenderers, then drop the renderers they hide
+    void cullOccludedRenderers(const glm::mat4& viewProjection);
+
+    struct Slot {
+        uint32_t generation = 0;
+        uint32_t denseIndex = 0;  // Position in gameObjects while the slot is live
+    };
+
+    GameObject* spawn(const std::string& name, bool uniqueName) {
+        uint32_t slot = objectPool.create(&registry, name, uniqueName);
+        GameObject* gameObject = objectPool.at(slot);
+
+        if (slot >= slots.size()) {
+            slots.resize(slot + 1);
+        }
+        slots[slot].denseIndex = static_cast<uint32_t>(gameObjects.size());
+        gameObject->setHandle({slot, slots[slot].generation});
+
+        gameObjects.push_back(gameObject);
+        addToIndexes(gameObject);
+        transformHierarchy.markDirty();
+        return gameObject;
+    }
+
+    void addToIndexes(GameObject* gameObject) {
+        uint32_t slot = gameObject->getHandle().index;
+        idIndex[gameObject->id] = slot;
+        nameIndex.emplace(gameObject->name, slot);
+    }
+
+    void removeFromIndexes(GameObject* gameObject) {
+        uint32_t slot = gameObject->getHandle().index;
+        auto idIt = idIndex.find(gameObject->id);
+        if (idIt != idIndex.end() && idIt->second == slot) {
+            idIndex.erase(idIt);
+        }
+
+        auto [begin, end] = nameIndex.equal_range(gameObject->name);
+        for (auto it = begin; it != end; ++it) {
+            if (it->second == slot) {
+                nameIndex.erase(it);
+                break;
+            }
+        }
+    }
+
     std::string name;
-    std::vector<std::unique_ptr<GameObject>> gameObjects;
+    EntityRegistry registry;  // Declared before the objects so it outlives them
+    SlabPool<GameObject> objectPool;        // Owns the GameObjects; slot == handle index
+    std::vector<Slot> slots;                // Indexed by slot
+    std::vector<GameObject*> gameObjects;   // Dense, in no particular order
+    std::unordered_map<uint64_t, uint32_t> idIndex;            // id -> slot
+    std::unordered_multimap<std::string, uint32_t> nameIndex;  // name -> slot
+    SystemScheduler systems;
+    RenderQueue renderQueue;  // Reused every frame
+    SceneBvh renderBvh;                           // Mesh renderers, for culling and proximity queries
+    std::vector<MeshRenderer*> visibleRenderers;  // Reused every frame
+    OcclusionBuffer occlusionBuffer;
+    std::vector<uint8_t> occlusionVisible;        // Per entry of visibleRenderers
+    std::vector<const ComponentType*> renderHooks;  // Render hooks of types render() doesn't draw itself
+    TransformHierarchy transformHierarchy;
+    std::vector<std::unique_ptr<CommandBuffer>> commandBuffers;  // Indexed by job thread
+    CommandBuffer sharedCommands{true};                           // Locked, for every other thread
+    std::vector<CommandBuffer::Command> flushing;                // Commands being applied
+    EventBus eventBus;
     bool isPlaying;
+    bool occlusionCulling = true;
+    uint64_t resetCount = 0;
 };
@@ -0,0 +1,238 @@
+/**
+ * @file scene_bvh.cpp
+ * @brief Bounding volume hierarchies over a scene's mesh renderers, kept up to date per frame
+ */
+#include <atomic>
+#include "scene_bvh.h"
+#include "gameobject.h"
+#include "components/meshrenderer.h"
+#include "components/transform_component.h"
+#include "jobs/job_system.h"
+#include "transform_hierarchy.h"
+
+void SceneBvh::update(const std::vector<MeshRenderer *> &renderers, uint64_t membershipVersion,
+                      const TransformHierarchy &transforms)
+{
+    // An object whose isStatic flag flipped is moved over on the frame after it's noticed;
+    // until then it is still culled correctly, just from the other tree
+    if (membershipVersion != seenMembership || repartition)
+    {
+        seenMembership = membershipVersion;
+        repartition = false;
+        partition(renderers);
+    }
+
+    // Meshes are rarely swapped, and nothing says which renderer's was, so look at all of them
+    uint32_t meshChanges = MeshRenderer::getMeshChangeCount();
+    bool checkAll = meshChanges != seenMeshChanges || transforms.allMoved();
+    seenMeshChanges = meshChanges;
+
+    for (Tree *tree : {&staticTree, &dynamicTree})
+    {
+        bool force = tree->needsBuild || tree->boundsStale;
+        tree->boundsStale = false;
+        tree->changed.clear();
+        if (force || checkAll)
+        {
+            for (uint32_t i = 0; i < tree->renderers.size(); ++i)
+            {
+                checkItem(*tree, i, force);
+            }
+        }
+    }
+
+    if (!transforms.allMoved())
+    {
+        for (const TransformComponent *transform : transforms.getMoved())
+        {
+            auto it = locations.find(transform);
+            if (it != locations.end())
+            {
+                checkItem(*it->second.tree, it->second.item, false);
+            }
+        }
+    }
+
+    if (refresh(staticTree) || staticTree.needsBuild)
+    {
+        rebuild(staticTree);
+    }
+
+    bool moved = refresh(dynamicTree);
+    if (dynamicTree.needsBuild)
+    {
+        rebuild(dynamicTree);
+    }
+    else if (moved)
+    {
+        dynamicTree.bvh.refit();
+        if (dynamicTree.bvh.getCost() > RebuildCostRatio * dynamicTree.builtCost)
+        {
+            rebuild(dynamicTree);
+        }
+    }
+}
+
+void SceneBvh::partition(const std::vector<MeshRenderer *> &renderers)
+{
+    nextStatic.clear();
+    nextDynamic.clear();
+    for (MeshRenderer *renderer : renderers)
+    {
+        (renderer->getOwner()->isStatic ? nextStatic : nextDynamic).push_back(renderer);
+    }
+
+    // Only a tree whose contents changed is rebuilt, so streaming in dynamic objects
+    // leaves the static tree alone and vice versa
+    auto assign = [](Tree &tree, std::vector<MeshRenderer *> &next)
+    {
+        if (next == tree.renderers)
+        {
+            // A removed renderer's slot may have been reused by a new one since the last
+            // update, so equal pointers don't mean equal objects; recheck every item
+            tree.boundsStale = true;
+            return;
+        }
+
+        tree.renderers.swap(next);
+        size_t count = tree.renderers.size();
+        tree.meshes.resize(count);
+        tree.worldVersions.resize(count);
+        tree.boxes.resize(count);
+        tree.radii.resize(count);
+        tree.needsBuild = true;
+    };
+    assign(staticTree, nextStatic);
+    assign(dynamicTree, nextDynamic);
+
+    // Rebuilt even if neither tree changed: a reused renderer may sit on another object now
+    locations.clear();
+    for (Tree *tree : {&staticTree, &dynamicTree})
+    {
+        for (uint32_t i = 0; i < tree->renderers.size(); ++i)
+        {
+            locations[tree->renderers[i]->getOwner()->getTransform()] = {tree, i};
+        }
+    }
+}
+
+void SceneBvh::checkItem(Tree &tree, uint32_t item, bool force)
+{
+    const MeshRenderer *renderer = tree.renderers[item];
+    const GameObject *owner = renderer->getOwner();
+    uint32_t version = owner->getTransform()->getWorldVersion();
+    const Mesh *mesh = renderer->getMeshPtr();
+    if (owner->isStatic != (&tree == &staticTree))
+    {
+        repartition = true;
+    }
+
+    // The versions also filter out transforms reported as moved more than once
+    if (force || version != tree.worldVersions[item] || mesh != tree.meshes[item])
+    {
+        tree.worldVersions[item] = version;
+        tree.meshes[item] = mesh;
+        tree.changed.push_back(item);
+    }
+}
+
+bool SceneBvh::refresh(Tree &tree)
+{
+    const std::vector<uint32_t> &changed = tree.changed;
+    if (changed.empty())
+        return false;
+
+    // World bounds only read transforms and meshes, so batches run on any thread
+    std::atomic<bool> moved{false};
+    auto refreshRange = [&](size_t begin, size_t end)
+    {
+        for (size_t k = begin; k < end; ++k)
+        {
+            uint32_t i = changed[k];
+            BoundingBox box;
+            float radius;
+            computeBounds(tree.renderers[i], box, radius);
+            if (tree.needsBuild)
+            {
+                tree.boxes[i] = box;
+                tree.radii[i] = radius;
+                continue;
+            }
+            if (box.min == tree.boxes[i].min && box.max == tree.boxes[i].max && radius == tree.radii[i])
+                continue;
+
+            tree.boxes[i] = box;
+            tree.radii[i] = radius;
+            tree.bvh.setItemBounds(i, box, radius);
+            moved.store(true, std::memory_order_relaxed);
+        }
+    };
+
+    if (changed.size() < ParallelThreshold)
+    {
+        refreshRange(0, changed.size());
+    }
+    else
+    {
+        Jobs().wait(Jobs().parallelFor(changed.size(), BatchSize, refreshRange));
+    }
+    return moved.load(std::memory_order_relaxed);
+}
+
+void SceneBvh::rebuild(Tree &tree)
+{
+    tree.bvh.build(tree.boxes.data(), tree.radii.data(), tree.renderers.size());
+    tree.builtCost = tree.bvh.getCost();
+    tree.needsBuild = false;
+}
+
+void SceneBvh::computeBounds(const MeshRenderer *renderer, BoundingBox &box, float &radius)
+{
+    const glm::mat4 &world = renderer->getOwner()->getTransform()->getWorldMatrix();
+    const Mesh *mesh = renderer->getMeshPtr();
+    if (!mesh)
+    {
+        // Nothing to draw yet; a point keeps it from inflating the tree
+        glm::vec3 position(world[3]);
+        box = {position, position};
+        radius = 0.0f;
+        return;
+    }
+    box = mesh->getBounds().transformed(world);
+    radius = mesh->getBoundingSphere().transformed(world).radius;
+}
+
+void SceneBvh::cull(const Frustum &frustum, std::vector<MeshRenderer *> &out)
+{
+    for (Tree *tree : {&staticTree, &dynamicTree})
+    {
+        hits.clear();
+        tree->bvh.cull(frustum, hits);
+        for (uint32_t item : hits)
+        {
+            out.push_back(tree->renderers[item]);
+        }
+    }
+}
+
+void SceneBvh::queryDistance(const glm::vec3 &point, float maxDistance, std::vector<MeshRenderer *> &out)
+{
+    for (Tree *tree : {&staticTree, &dynamicTree})
+    {
+        hits.clear();
+        tree->bvh.queryDistance(point, maxDistance, hits);
+        for (uint32_t item : hits)
+        {
+            out.push_back(tree->renderers[item]);
+        }
+    }
+}
+
+void SceneBvh::clear()
+{
+    staticTree = Tree();
+    dynamicTree = Tree();
+    locations.clear();
+    seenMembership = ~0ull;
+    repartition = true;
+}
@@ -0,0 +1,100 @@
+/**
+ * @file scene_bvh.h
+ * @brief Bounding volume hierarchies over a scene's mesh renderers, kept up to date per frame
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+#include "math/bvh.h"
+
+class Mesh;
+class MeshRenderer;
+class TransformComponent;
+class TransformHierarchy;
+
+/**
+ * @brief Culling and proximity queries over the scene's mesh renderers.
+ *
+ * Renderers on objects flagged isStatic go into one tree, all others into another. The
+ * static tree gets a full SAH build whenever anything in it changes, which for static
+ * geometry should be rare. The dynamic tree is refit in place when its objects move and
+ * only rebuilt once refitting has made it markedly more expensive to query.
+ *
+ * update() only revisits the items whose world transform the hierarchy reports as moved,
+ * so a frame costs in proportion to what moved, not to the size of the scene; queries
+ * then only descend into the parts of the trees they touch. Every item is looked at
+ * again only after membership changes or after any renderer's mesh was set. An object's
+ * isStatic flag is read at those times and whenever it moves.
+ */
+class SceneBvh
+{
+public:
+    /**
+     * @brief Bring both trees up to date. Main thread only, after world transforms are.
+     * @param renderers The active mesh renderers, as returned by the registry.
+     * @param membershipVersion The registry's version of that list; skips the membership check if unchanged.
+     * @param transforms The scene's hierarchy, for the transforms that moved; the caller clears them after.
+     */
+    void update(const std::vector<MeshRenderer *> &renderers, uint64_t membershipVersion,
+                const TransformHierarchy &transforms);
+
+    // Append the renderers whose world bounds may intersect frustum
+    void cull(const Frustum &frustum, std::vector<MeshRenderer *> &out);
+
+    // Append the renderers whose world bounds come within maxDistance of point
+    void queryDistance(const glm::vec3 &point, float maxDistance, std::vector<MeshRenderer *> &out);
+
+    // Forget every renderer; the next update() rebuilds from scratch
+    void clear();
+
+private:
+    static constexpr float RebuildCostRatio = 2.0f;      // Refit trees this much worse than built get rebuilt
+    static constexpr size_t ParallelThreshold = 1024;    // Fewer changed items are refreshed inline
+    static constexpr size_t BatchSize = 256;
+
+    struct Tree
+    {
+        Bvh bvh;
+        std::vector<MeshRenderer *> renderers; // Indexed by Bvh item
+        std::vector<const Mesh *> meshes;      // Mesh the bounds were computed for
+        std::vector<uint32_t> worldVersions;   // Transform version the bounds were computed for
+        std::vector<BoundingBox> boxes;        // World space
+        std::vector<float> radii;
+        float builtCost = 0.0f;                // getCost() right after the last build
+        std::vector<uint32_t> changed;         // Items checkItem() found out of date
+        bool needsBuild = false;               // Contents changed; bounds are all recomputed, then built
+        bool boundsStale = false;              // Membership changed; the same pointer may be another object now
+    };
+
+    struct Location
+    {
+        Tree *tree;
+        uint32_t item;
+    };
+
+    // Split renderers into the two trees, rebuilding whichever one's contents changed
+    void partition(const std::vector<MeshRenderer *> &renderers);
+
+    // Queue item for refresh if its mesh or world transform changed since its bounds were computed
+    void checkItem(Tree &tree, uint32_t item, bool force);
+
+    // Recompute bounds of the queued items; returns whether any bounds moved
+    bool refresh(Tree &tree);
+
+    void rebuild(Tree &tree);
+
+    static void computeBounds(const MeshRenderer *renderer, BoundingBox &box, float &radius);
+
+    Tree staticTree;
+    Tree dynamicTree;
+    std::unordered_map<const TransformComponent *, Location> locations; // Where each item's transform is
+    uint64_t seenMembership = ~0ull;
+    uint32_t seenMeshChanges = 0;  // MeshRenderer::getMeshChangeCount() as of the last update
+    bool repartition = true;       // Set when an item's isStatic flag no longer matches its tree
+    std::vector<uint32_t> hits;    // Scratch, Bvh query results
+    std::vector<MeshRenderer *> nextStatic;
+    std::vector<MeshRenderer *> nextDynamic;
+};
@@ -0,0 +1,145 @@
+/**
+ * @file scene_snapshot.cpp
+ * @brief In-memory copy of a scene's objects and component data, for play mode
+ */
+#include <unordered_map>
+#include "scene_snapshot.h"
+#include "scene.h"
+#include "../helpers/logging.h"
+
+void SceneSnapshot::clear()
+{
+    objects.clear();
+    components.clear();
+    registry.clear();
+}
+
+void SceneSnapshot::capture(Scene &scene)
+{
+    clear();
+    sceneName = scene.name;
+
+    const std::vector<GameObject *> &gameObjects = scene.getAllGameObjects();
+    objects.reserve(gameObjects.size());
+    for (const GameObject *gameObject : gameObjects)
+    {
+        const TransformComponent *transform = gameObject->getTransform();
+
+        ObjectRecord record;
+        record.id = gameObject->id;
+        record.parentId = gameObject->getParent() ? gameObject->getParent()->id : 0;
+        record.name = gameObject->name;
+        record.isStatic = gameObject->isStatic;
+        record.active = gameObject->isActive();
+        record.transform = {transform->getPosition(), transform->getRotation(), transform->getScale()};
+        record.entity = registry.create();
+        record.firstComponent = static_cast<uint32_t>(components.size());
+
+        for (const Component *component : gameObject->getAllComponents())
+        {
+            if (component == transform)
+                continue;
+
+            const ComponentType *type = ComponentFactory::getInstance().find(component->getTypeName());
+            if (!type)
+                continue;
+
+            components.push_back({type, type->clone(registry, record.entity, *component)});
+        }
+        record.componentCount = static_cast<uint32_t>(components.size()) - record.firstComponent;
+        objects.push_back(std::move(record));
+    }
+}
+
+void SceneSnapshot::load(const json &objectsArray)
+{
+    clear();
+
+    for (const auto &objectJson : objectsArray)
+    {
+        ObjectRecord record;
+        record.id = objectJson.at("id").get<uint64_t>();
+        record.parentId = objectJson.value("parent", uint64_t(0));
+        record.name = objectJson.at("name").get<std::string>();
+        record.isStatic = objectJson.value("isStatic", false);
+        record.active = objectJson.value("isActive", true);
+        record.entity = registry.create();
+        record.firstComponent = static_cast<uint32_t>(components.size());
+
+        for (const auto &componentJson : objectJson.at("components"))
+        {
+            const std::string &typeName = componentJson["type"].get_ref<const std::string &>();
+            const ComponentType *type = ComponentFactory::getInstance().find(typeName);
+            if (!type)
+            {
+                LOG_WARNING("Skipping unknown component type {}", typeName);
+                continue;
+            }
+
+            Component *component = type->create(registry, record.entity);
+            component->deserialize(componentJson);
+            if (type->id == componentTypeId<TransformComponent>())
+            {
+                const auto *transform = static_cast<const TransformComponent *>(component);
+                record.transform = {transform->getPosition(), transform->getRotation(), transform->getScale()};
+                continue;
+            }
+            components.push_back({type, component});
+        }
+        record.componentCount = static_cast<uint32_t>(components.size()) - record.firstComponent;
+        objects.push_back(std::move(record));
+    }
+}
+
+void SceneSnapshot::restore(Scene &scene) const
+{
+    scene.clearScene();
+    scene.name = sceneName;
+    instantiate(scene);
+}
+
+std::vector<GameObjectHandle> SceneSnapshot::instantiate(Scene &scene) const
+{
+    std::vector<GameObjectHandle> handles;
+    handles.reserve(objects.size());
+
+    std::unordered_map<uint64_t, GameObject *> byId;
+    byId.reserve(objects.size());
+    for (const ObjectRecord &record : objects)
+    {
+        GameObject *gameObject = scene.spawn(record.name, false);
+        scene.removeFromIndexes(gameObject);
+        gameObject->id = record.id;
+        GameObject::reserveId(record.id);
+        scene.addToIndexes(gameObject);
+
+        gameObject->isStatic = record.isStatic;
+        gameObject->getTransform()->setLocal(record.transform.position, record.transform.rotation,
+                                             record.transform.scale);
+        for (uint32_t i = 0; i < record.componentCount; ++i)
+        {
+            const Prefab::Entry &entry = components[record.firstComponent + i];
+            Component *component = entry.type->clone(scene.registry, gameObject->entity, *entry.prototype);
+            gameObject->attachComponent(component, entry.type->id);
+        }
+        gameObject->setActive(record.active);
+        byId.emplace(record.id, gameObject);
+        handles.push_back(gameObject->getHandle());
+    }
+
+    // Transforms were captured local to their parents. A parent outside this batch may
+    // already be in the scene.
+    for (const ObjectRecord &record : objects)
+    {
+        if (record.parentId == 0)
+            continue;
+
+        auto parent = byId.find(record.parentId);
+        GameObject *parentObject = parent != byId.end() ? parent->second : scene.findGameObjectById(record.parentId);
+        if (parentObject)
+        {
+            scene.setParent(byId[record.id], parentObject, false);
+        }
+    }
+    return handles;
+}
@@ -0,0 +1,60 @@
+/**
+ * @file scene_snapshot.h
+ * @brief In-memory copy of a scene's objects and component data, for play mode
+ */
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "gameobject_handle.h"
+#include "prefab.h"
+#include "ecs/entity_registry.h"
+
+class Scene;
+
+/**
+ * @brief Everything needed to put a scene back the way it was, without going through JSON.
+ *
+ * capture() copies every component into pools the snapshot owns, using the factory's
+ * clone hook; restore() rebuilds the scene's objects with their original ids, names and
+ * parents and clones the components back. Neither step formats or parses text, so a
+ * round trip costs about as much as spawning the objects. Pointers and handles into the
+ * scene are invalid after restore(); look objects up again by id.
+ *
+ * load() fills a snapshot from saved object data without touching any scene, so it can
+ * run on a worker thread; instantiate() then adds the objects to a scene in one go.
+ */
+class SceneSnapshot
+{
+public:
+    void capture(Scene &scene);
+    void restore(Scene &scene) const;
+
+    // Objects in the format GameObject::serialize writes, e.g. a scene file's "gameObjects"
+    void load(const json &objectsArray);
+
+    // Add the objects to the scene, next to what is already there
+    std::vector<GameObjectHandle> instantiate(Scene &scene) const;
+
+    bool empty() const { return objects.empty(); }
+    void clear();
+
+private:
+    struct ObjectRecord
+    {
+        uint64_t id;
+        uint64_t parentId; // 0 for roots
+        std::string name;
+        bool isStatic;
+        bool active;
+        InstanceTransform transform;
+        Entity entity;           // Holds this object's component copies in registry
+        uint32_t firstComponent; // Range in components
+        uint32_t componentCount;
+    };
+
+    std::string sceneName;
+    std::vector<ObjectRecord> objects;
+    std::vector<Prefab::Entry> components; // Every component but the transforms
+    EntityRegistry registry;
+};
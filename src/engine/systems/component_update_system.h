@@ -0,0 +1,32 @@
+/**
+ * @file component_update_system.h
+ * @brief Runs the Update hook of component types that have no system of their own
+ */
+#pragma once
+#include <vector>
+#include "system.h"
+#include "../scene.h"
+#include "../component_factory.h"
+
+class ComponentUpdateSystem : public System
+{
+public:
+    // types: factory entries with an update hook
+    explicit ComponentUpdateSystem(std::vector<const ComponentType *> types)
+        : System("ComponentUpdate"), types(std::move(types))
+    {
+        writesEverything(); // An Update hook may touch any component
+        requireMainThread();
+    }
+
+    void update(Scene &scene, float deltaTime) override
+    {
+        for (const ComponentType *type : types)
+        {
+            type->update(scene.getRegistry(), deltaTime);
+        }
+    }
+
+private:
+    std::vector<const ComponentType *> types;
+};
@@ -0,0 +1,28 @@
+/**
+ * @file first_person_controller_system.h
+ * @brief Applies mouse-look and WASD movement to objects with a FirstPersonController
+ */
+#pragma once
+#include "system.h"
+#include "../scene.h"
+#include "../components/first_person_controller.h"
+#include "../components/transform_component.h"
+
+class FirstPersonControllerSystem : public System
+{
+public:
+    FirstPersonControllerSystem() : System("FirstPersonController")
+    {
+        updates<FirstPersonController>();
+        writes<TransformComponent>();
+        requireMainThread(); // Reads mouse and keyboard state through SDL
+    }
+
+    void update(Scene &scene, float deltaTime) override
+    {
+        for (FirstPersonController *controller : scene.active<FirstPersonController>())
+        {
+            controller->FirstPersonController::Update(deltaTime);
+        }
+    }
+};
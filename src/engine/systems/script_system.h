@@ -0,0 +1,28 @@
+/**
+ * @file script_system.h
+ * @brief Ticks the Lua scripts attached to game objects
+ */
+#pragma once
+#include "system.h"
+#include "../scene.h"
+#include "../components/script_component.h"
+#include "../components/transform_component.h"
+
+class ScriptSystem : public System
+{
+public:
+    ScriptSystem() : System("Scripts")
+    {
+        updates<ScriptComponent>();
+        writes<TransformComponent>(); // Scripts move their own object
+        requireMainThread();          // Lua states are not shared across threads
+    }
+
+    void update(Scene &scene, float deltaTime) override
+    {
+        for (ScriptComponent *script : scene.active<ScriptComponent>())
+        {
+            script->ScriptComponent::Update(deltaTime);
+        }
+    }
+};
@@ -0,0 +1,78 @@
+/**
+ * @file system.h
+ * @brief Base class for per-frame logic that runs over the components of a scene
+ */
+#pragma once
+#include "../ecs/component_type.h"
+
+class Scene;
+
+/**
+ * @brief A unit of per-frame work that declares which component types it touches.
+ *
+ * Subclasses call reads<...>() and writes<...>() in their constructor. The scheduler
+ * uses those declarations to run systems that don't conflict at the same time, so a
+ * system must not touch any component type it hasn't declared. Systems may change
+ * component data but not add or remove components or objects while they run.
+ */
+class System
+{
+public:
+    explicit System(const char *name) : name(name) {}
+    virtual ~System() = default;
+
+    virtual void update(Scene &scene, float deltaTime) = 0;
+
+    const char *getName() const { return name; }
+    const ComponentMask &getReads() const { return readMask; }
+    const ComponentMask &getWrites() const { return writeMask; }
+    const ComponentMask &getUpdates() const { return updateMask; }
+    bool runsOnMainThread() const { return mainThreadOnly; }
+
+    // Two systems conflict if either writes a type the other one reads or writes
+    bool conflictsWith(const System &other) const
+    {
+        return (writeMask & (other.readMask | other.writeMask)).any() ||
+               (other.writeMask & readMask).any();
+    }
+
+protected:
+    template <typename... Ts>
+    void reads()
+    {
+        (readMask.set(componentTypeId<Ts>()), ...);
+    }
+
+    template <typename... Ts>
+    void writes()
+    {
+        (writeMask.set(componentTypeId<Ts>()), ...);
+    }
+
+    // For systems that call the Update hook of Ts themselves, so nothing else does
+    template <typename... Ts>
+    void updates()
+    {
+        writes<Ts...>();
+        (updateMask.set(componentTypeId<Ts>()), ...);
+    }
+
+    // For systems that can't know what they touch: they conflict with every other system
+    void writesEverything()
+    {
+        writeMask.set();
+    }
+
+    // For systems that call into APIs that aren't thread-safe (Lua, SDL, OpenGL)
+    void requireMainThread()
+    {
+        mainThreadOnly = true;
+    }
+
+private:
+    const char *name;
+    ComponentMask readMask;
+    ComponentMask writeMask;
+    ComponentMask updateMask;
+    bool mainThreadOnly = false;
+};
@@ -0,0 +1,46 @@
+/**
+ * @file system_scheduler.cpp
+ * @brief Builds the system dependency graph and dispatches it to the job system
+ */
+#include "system_scheduler.h"
+
+void SystemScheduler::update(Scene &scene, float deltaTime)
+{
+    handles.assign(systems.size(), JobHandle());
+
+    for (size_t i = 0; i < systems.size(); ++i)
+    {
+        System *system = systems[i].get();
+
+        dependencies.clear();
+        for (size_t j = 0; j < i; ++j)
+        {
+            if (handles[j].isValid() && system->conflictsWith(*systems[j]))
+            {
+                dependencies.push_back(handles[j]);
+            }
+        }
+
+        if (system->runsOnMainThread())
+        {
+            // Helps with queued work while waiting. Once it returns the system has run,
+            // so later systems need no handle to depend on.
+            for (const JobHandle &dependency : dependencies)
+            {
+                Jobs().wait(dependency);
+            }
+            system->update(scene, deltaTime);
+            continue;
+        }
+
+        handles[i] = Jobs().schedule([system, &scene, deltaTime]()
+        {
+            system->update(scene, deltaTime);
+        }, dependencies);
+    }
+
+    for (const JobHandle &handle : handles)
+    {
+        Jobs().wait(handle);
+    }
+}
@@ -0,0 +1,41 @@
+/**
+ * @file system_scheduler.h
+ * @brief Runs a scene's systems once per frame, in parallel where their access allows
+ */
+#pragma once
+#include <memory>
+#include <utility>
+#include <vector>
+#include "system.h"
+#include "../jobs/job_system.h"
+
+/**
+ * @brief Ordered list of systems plus the per-frame dependency graph between them.
+ *
+ * Each frame a system waits for every earlier system it conflicts with and nothing
+ * else, so registration order only matters between systems that share a component
+ * type. Systems that don't conflict run concurrently on the job system. Systems that
+ * require the main thread run inline on the caller once their dependencies are done.
+ */
+class SystemScheduler
+{
+public:
+    template <typename T, typename... Args>
+    T *addSystem(Args &&...args)
+    {
+        auto system = std::make_unique<T>(std::forward<Args>(args)...);
+        T *result = system.get();
+        systems.push_back(std::move(system));
+        return result;
+    }
+
+    // Runs every system exactly once and returns when all of them have finished
+    void update(Scene &scene, float deltaTime);
+
+    const std::vector<std::unique_ptr<System>> &getSystems() const { return systems; }
+
+private:
+    std::vector<std::unique_ptr<System>> systems;
+    std::vector<JobHandle> handles;       // Indexed like systems, reused every frame
+    std::vector<JobHandle> dependencies;  // Scratch list for the system being scheduled
+};
@@ -0,0 +1,175 @@
+/**
+ * @file transform_hierarchy.cpp
+ * @brief Depth-sorted parent/child order used to propagate world transforms
+ */
+#include "transform_hierarchy.h"
+#include "gameobject.h"
+#include "jobs/job_system.h"
+#include "math/transform_kernel.h"
+
+template <typename Fn>
+void TransformHierarchy::forRange(size_t count, Fn &&fn)
+{
+    if (count < ParallelThreshold)
+    {
+        fn(0, count);
+        return;
+    }
+
+    Jobs().wait(Jobs().parallelFor(count, BatchSize, fn));
+}
+
+void TransformHierarchy::update(const std::vector<GameObject *> &gameObjects)
+{
+    if (structureDirty)
+    {
+        rebuild(gameObjects);
+        structureDirty = false;
+    }
+
+    // Find the transforms that changed since the last update
+    stale.clear();
+    for (size_t i = 0; i < nodes.size(); ++i)
+    {
+        bool moved = nodes[i].seenVersion != nodes[i].transform->getVersion();
+        changed[i] = moved;
+        if (moved)
+        {
+            stale.push_back(static_cast<uint32_t>(i));
+        }
+    }
+
+    // Rebuild their local matrices in one batch
+    if (!stale.empty())
+    {
+        stalePositions.resize(stale.size());
+        staleRotations.resize(stale.size());
+        staleScales.resize(stale.size());
+        staleMatrices.resize(stale.size());
+        staleNormals.resize(stale.size());
+        forRange(stale.size(), [this](size_t begin, size_t end)
+        {
+            composeLocals(begin, end);
+        });
+    }
+
+    // Then the world matrices, one depth level at a time
+    for (size_t level = 0; level + 1 < levelStarts.size(); ++level)
+    {
+        size_t begin = levelStarts[level];
+        forRange(levelStarts[level + 1] - begin, [this, begin](size_t first, size_t last)
+        {
+            propagate(begin + first, begin + last);
+        });
+    }
+
+    // Nobody consuming the list must not let it grow without bound
+    if (movedOverflow)
+        return;
+    for (size_t i = 0; i < nodes.size(); ++i)
+    {
+        if (changed[i])
+        {
+            moved.push_back(nodes[i].transform);
+        }
+    }
+    if (moved.size() > nodes.size())
+    {
+        moved.clear();
+        movedOverflow = true;
+    }
+}
+
+void TransformHierarchy::rebuild(const std::vector<GameObject *> &gameObjects)
+{
+    nodes.clear();
+    levelStarts.clear();
+
+    // Breadth-first from the roots; scratch mirrors nodes with the owning objects
+    scratch.clear();
+    for (GameObject *gameObject : gameObjects)
+    {
+        if (!gameObject->getParent())
+        {
+            scratch.push_back(gameObject);
+            nodes.push_back({gameObject->getTransform(), NoParent, 0});
+        }
+    }
+
+    size_t levelBegin = 0;
+    while (levelBegin < nodes.size())
+    {
+        levelStarts.push_back(levelBegin);
+        size_t levelEnd = nodes.size();
+        for (size_t i = levelBegin; i < levelEnd; ++i)
+        {
+            for (GameObject *child : scratch[i]->getChildren())
+            {
+                scratch.push_back(child);
+                nodes.push_back({child->getTransform(), static_cast<uint32_t>(i), 0});
+            }
+        }
+        levelBegin = levelEnd;
+    }
+    levelStarts.push_back(nodes.size());
+
+    // Every matrix is rebuilt on the first update after a structural change
+    for (Node &node : nodes)
+    {
+        node.seenVersion = node.transform->getVersion() - 1;
+    }
+    localMatrices.resize(nodes.size());
+    localNormals.resize(nodes.size());
+    changed.assign(nodes.size(), 0);
+    moved.clear();
+    movedOverflow = true;
+}
+
+void TransformHierarchy::composeLocals(size_t begin, size_t end)
+{
+    for (size_t k = begin; k < end; ++k)
+    {
+        const TransformComponent *transform = nodes[stale[k]].transform;
+        stalePositions[k] = transform->getPosition();
+        staleRotations[k] = transform->getRotation();
+        staleScales[k] = transform->getScale();
+    }
+
+    composeTransforms(&stalePositions[begin], &staleRotations[begin], &staleScales[begin], end - begin,
+                      &staleMatrices[begin], &staleNormals[begin]);
+
+    for (size_t k = begin; k < end; ++k)
+    {
+        Node &node = nodes[stale[k]];
+        localMatrices[stale[k]] = staleMatrices[k];
+        localNormals[stale[k]] = staleNormals[k];
+        node.seenVersion = node.transform->getVersion();
+    }
+}
+
+void TransformHierarchy::propagate(size_t begin, size_t end)
+{
+    for (size_t i = begin; i < end; ++i)
+    {
+        Node &node = nodes[i];
+        bool parentChanged = node.parent != NoParent && changed[node.parent];
+        if (!parentChanged && !changed[i])
+            continue;
+
+        TransformComponent *transform = node.transform;
+        if (node.parent == NoParent)
+        {
+            transform->worldMatrix = localMatrices[i];
+            transform->normalMatrix = localNormals[i];
+        }
+        else
+        {
+            // inverse-transpose distributes over products, so normal matrices chain like models
+            const TransformComponent *parent = nodes[node.parent].transform;
+            transform->worldMatrix = parent->worldMatrix * localMatrices[i];
+            transform->normalMatrix = parent->normalMatrix * localNormals[i];
+        }
+        ++transform->worldVersion;
+        changed[i] = 1;
+    }
+}
@@ -0,0 +1,89 @@
+/**
+ * @file transform_hierarchy.h
+ * @brief Depth-sorted parent/child order used to propagate world transforms
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+class GameObject;
+class TransformComponent;
+
+/**
+ * @brief Flattened copy of the scene's parent/child tree, sorted by depth.
+ *
+ * Roots come first, then all objects at depth 1, then depth 2 and so on, so every
+ * parent sits before its children and world matrices can be computed in one forward
+ * pass over contiguous memory. Each depth level only depends on the one above it, so
+ * large levels are split across the job system. The order is rebuilt only after the
+ * tree changes; between changes an update only rewrites transforms that moved, or
+ * whose parent did.
+ *
+ * Local matrices are cached here, next to the order, rather than in the components.
+ * Those of the transforms that changed are gathered into flat arrays and built in one
+ * SIMD batch (composeTransforms) before the world pass.
+ *
+ * Transforms whose world matrix was rewritten are collected until clearMoved(), so code
+ * that keeps world-space data, like the scene's BVH, only revisits what moved.
+ */
+class TransformHierarchy
+{
+public:
+    // Call whenever objects are created, removed or reparented
+    void markDirty() { structureDirty = true; }
+
+    void update(const std::vector<GameObject *> &gameObjects);
+
+    // Transforms whose world matrix changed since clearMoved(), possibly more than once.
+    // When allMoved() is set the list is empty and every transform counts as moved.
+    const std::vector<TransformComponent *> &getMoved() const { return moved; }
+    bool allMoved() const { return movedOverflow; }
+    void clearMoved()
+    {
+        moved.clear();
+        movedOverflow = false;
+    }
+
+private:
+    static constexpr uint32_t NoParent = UINT32_MAX;
+
+    // Levels smaller than this aren't worth handing to the job system
+    static constexpr size_t ParallelThreshold = 1024;
+    static constexpr size_t BatchSize = 256;
+
+    struct Node
+    {
+        TransformComponent *transform;
+        uint32_t parent;      // Index into nodes, NoParent for roots
+        uint32_t seenVersion; // Transform version the world matrix was last built from
+    };
+
+    void rebuild(const std::vector<GameObject *> &gameObjects);
+    void composeLocals(size_t begin, size_t end);
+    void propagate(size_t begin, size_t end);
+
+    // Runs fn(begin, end) over [0, count), on the job system when count is large
+    template <typename Fn>
+    void forRange(size_t count, Fn &&fn);
+
+    std::vector<Node> nodes;
+    std::vector<glm::mat4> localMatrices; // Per node
+    std::vector<glm::mat3> localNormals;  // Per node
+    std::vector<size_t> levelStarts; // First node of each depth, plus nodes.size() at the end
+    std::vector<uint8_t> changed;    // Per node: local or world matrix rewritten this update
+    std::vector<GameObject *> scratch;
+    std::vector<TransformComponent *> moved;
+    bool movedOverflow = true; // After a rebuild, or once moved would outgrow nodes
+
+    // Transforms whose local matrix is out of date, gathered for the batch kernel
+    std::vector<uint32_t> stale;
+    std::vector<glm::vec3> stalePositions;
+    std::vector<glm::quat> staleRotations;
+    std::vector<glm::vec3> staleScales;
+    std::vector<glm::mat4> staleMatrices;
+    std::vector<glm::mat3> staleNormals;
+    bool structureDirty = true;
+};
@@ -0,0 +1,301 @@
+/**
+ * @file world_partition.cpp
+ * @brief Splits a world into grid cells on disk and streams in the ones near the viewer
+ */
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include "world_partition.h"
+#include "scene.h"
+#include "../helpers/logging.h"
+
+namespace
+{
+    const char *ManifestFileName = "world.json";
+
+    void serializeSubtree(const GameObject *gameObject, json &objectsArray)
+    {
+        json objectJson;
+        gameObject->serialize(objectJson);
+        objectsArray.push_back(std::move(objectJson));
+
+        for (const GameObject *child : gameObject->getChildren())
+        {
+            serializeSubtree(child, objectsArray);
+        }
+    }
+
+    bool writeJson(const std::filesystem::path &path, const json &j)
+    {
+        std::ofstream file(path);
+        if (!file.is_open())
+        {
+            LOG_ERROR("Failed to open file for writing: {}", path.string());
+            return false;
+        }
+        file << std::setw(4) << j << std::endl;
+        return !file.fail();
+    }
+}
+
+WorldPartition::~WorldPartition()
+{
+    close();
+}
+
+std::string WorldPartition::cellFileName(int x, int z)
+{
+    return "cell_" + std::to_string(x) + "_" + std::to_string(z) + ".json";
+}
+
+bool WorldPartition::save(Scene &scene, const std::string &directory, float cellSize)
+{
+    scene.updateWorldTransforms();
+
+    // Whole subtrees go to the cell their root stands in
+    std::unordered_map<uint64_t, std::pair<glm::ivec2, json>> cellObjects;
+    for (const GameObject *gameObject : scene.getAllGameObjects())
+    {
+        if (gameObject->getParent())
+            continue;
+
+        glm::vec3 position = gameObject->getTransform()->getWorldPosition();
+        int x = static_cast<int>(std::floor(position.x / cellSize));
+        int z = static_cast<int>(std::floor(position.z / cellSize));
+
+        auto [it, inserted] = cellObjects.try_emplace(cellKey(x, z), glm::ivec2(x, z), json::array());
+        serializeSubtree(gameObject, it->second.second);
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error)
+    {
+        LOG_ERROR("Failed to create world directory {}: {}", directory, error.message());
+        return false;
+    }
+
+    json manifest;
+    manifest["cellSize"] = cellSize;
+    manifest["cells"] = json::array();
+    for (auto &[key, cell] : cellObjects)
+    {
+        json cellJson;
+        cellJson["gameObjects"] = std::move(cell.second);
+        if (!writeJson(std::filesystem::path(directory) / cellFileName(cell.first.x, cell.first.y), cellJson))
+            return false;
+
+        manifest["cells"].push_back({cell.first.x, cell.first.y});
+    }
+
+    if (!writeJson(std::filesystem::path(directory) / ManifestFileName, manifest))
+        return false;
+
+    LOG_INFO("World saved to {} as {} cells", directory, cellObjects.size());
+    return true;
+}
+
+bool WorldPartition::open(const std::string &worldDirectory)
+{
+    close();
+
+    try
+    {
+        std::ifstream file(std::filesystem::path(worldDirectory) / ManifestFileName);
+        if (!file.is_open())
+        {
+            LOG_ERROR("No world manifest in {}", worldDirectory);
+            return false;
+        }
+
+        json manifest;
+        file >> manifest;
+
+        directory = worldDirectory;
+        seenResetCount = scene.getResetCount();
+        cellSize = manifest.at("cellSize").get<float>();
+        for (const auto &cellJson : manifest.at("cells"))
+        {
+            Cell cell;
+            cell.x = cellJson.at(0).get<int>();
+            cell.z = cellJson.at(1).get<int>();
+            cells.emplace(cellKey(cell.x, cell.z), std::move(cell));
+        }
+    }
+    catch (const std::exception &e)
+    {
+        LOG_ERROR("Failed to open world {}: {}", worldDirectory, e.what());
+        cells.clear();
+        return false;
+    }
+
+    LOG_INFO("Opened world {} with {} cells", worldDirectory, cells.size());
+    return true;
+}
+
+void WorldPartition::update(const glm::vec3 &position)
+{
+    // The margin keeps a viewer on a cell border from loading and unloading it every frame
+    float unloadRadius = loadRadius + cellSize;
+
+    if (scene.getResetCount() != seenResetCount)
+    {
+        rebindCells();
+    }
+
+    for (auto &[key, cell] : cells)
+    {
+        float distance = distanceTo(cell, position);
+        switch (cell.state)
+        {
+        case Cell::State::Unloaded:
+            if (distance < loadRadius)
+            {
+                startLoad(cell);
+            }
+            break;
+
+        case Cell::State::Loading:
+            if (!cell.job.isDone())
+                break;
+
+            // Integrate the whole cell at once, unless the viewer has moved away meanwhile
+            if (distance < unloadRadius)
+            {
+                cell.objects = cell.pending->instantiate(scene);
+                cell.objectIds.clear();
+                for (GameObjectHandle handle : cell.objects)
+                {
+                    cell.objectIds.push_back(scene.resolve(handle)->id);
+                }
+                cell.state = Cell::State::Loaded;
+            }
+            else
+            {
+                cell.state = Cell::State::Unloaded;
+            }
+            cell.pending.reset();
+            cell.job = {};
+            break;
+
+        case Cell::State::Loaded:
+            if (distance > unloadRadius)
+            {
+                unload(cell);
+            }
+            break;
+        }
+    }
+}
+
+void WorldPartition::close()
+{
+    for (auto &[key, cell] : cells)
+    {
+        if (cell.state == Cell::State::Loading)
+        {
+            Jobs().wait(cell.job);
+        }
+        else if (cell.state == Cell::State::Loaded)
+        {
+            unload(cell);
+        }
+    }
+    cells.clear();
+}
+
+size_t WorldPartition::getLoadedCellCount() const
+{
+    size_t count = 0;
+    for (const auto &[key, cell] : cells)
+    {
+        count += cell.state == Cell::State::Loaded ? 1 : 0;
+    }
+    return count;
+}
+
+float WorldPartition::distanceTo(const Cell &cell, const glm::vec3 &position) const
+{
+    glm::vec2 centre((cell.x + 0.5f) * cellSize, (cell.z + 0.5f) * cellSize);
+    return glm::length(centre - glm::vec2(position.x, position.z));
+}
+
+void WorldPartition::startLoad(Cell &cell)
+{
+    auto snapshot = std::make_shared<SceneSnapshot>();
+    std::string path = (std::filesystem::path(directory) / cellFileName(cell.x, cell.z)).string();
+
+    // File reading, parsing and component deserialization all happen off the main thread
+    cell.pending = snapshot;
+    cell.job = Jobs().schedule([snapshot, path]()
+    {
+        try
+        {
+            std::ifstream file(path);
+            if (!file.is_open())
+            {
+                LOG_ERROR("Failed to open world cell {}", path);
+                return;
+            }
+
+            json j;
+            file >> j;
+            snapshot->load(j.at("gameObjects"));
+        }
+        catch (const std::exception &e)
+        {
+            LOG_ERROR("Failed to load world cell {}: {}", path, e.what());
+            snapshot->clear();
+        }
+    });
+    cell.state = Cell::State::Loading;
+}
+
+void WorldPartition::unload(Cell &cell)
+{
+    // Children are removed with their root; their handles then simply resolve to nothing
+    for (GameObjectHandle handle : cell.objects)
+    {
+        scene.removeGameObject(handle);
+    }
+    cell.objects.clear();
+    cell.state = Cell::State::Unloaded;
+}
+
+void WorldPartition::rebindCells()
+{
+    seenResetCount = scene.getResetCount();
+    for (auto &[key, cell] : cells)
+    {
+        // A restored snapshot brings back, under their original ids, the objects of every
+        // cell that was loaded when it was taken. Those cells keep them, edits included;
+        // cells with none left, such as ones streamed in since, load again when in range.
+        cell.objects.clear();
+        for (uint64_t id : cell.objectIds)
+        {
+            if (GameObject *gameObject = scene.findGameObjectById(id))
+            {
+                cell.objects.push_back(gameObject->getHandle());
+            }
+        }
+
+        if (cell.objects.empty())
+        {
+            if (cell.state == Cell::State::Loaded)
+            {
+                cell.state = Cell::State::Unloaded;
+            }
+            continue;
+        }
+
+        // The cell was unloaded or reloading since the snapshot; what it would add is back already
+        if (cell.state == Cell::State::Loading)
+        {
+            Jobs().wait(cell.job);
+            cell.job = {};
+            cell.pending.reset();
+        }
+        cell.state = Cell::State::Loaded;
+    }
+}
@@ -0,0 +1,101 @@
+/**
+ * @file world_partition.h
+ * @brief Splits a world into grid cells on disk and streams in the ones near the viewer
+ */
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+#include "gameobject_handle.h"
+#include "scene_snapshot.h"
+#include "jobs/job_system.h"
+
+class Scene;
+
+/**
+ * @brief Streams a world, saved as one file per cell, into a scene around the viewer.
+ *
+ * The world is cut into square cells on the XZ plane. save() writes each cell's objects to
+ * its own file plus a small manifest. When streaming, update() is called once per frame
+ * at a frame boundary with the viewer's position. Cells within the load radius are read
+ * and deserialized by a background job into a SceneSnapshot; the next update() after the
+ * job finishes adds the objects to the scene in one batch. Cells beyond the unload radius
+ * have their objects removed. Only the manifest has to be in memory up front, so load
+ * time and memory follow what is near the viewer rather than the size of the world.
+ *
+ * Objects belong to the cell their root ancestor stands in and are saved with their
+ * whole subtree. Changes made to a streamed object are lost when its cell unloads.
+ */
+class WorldPartition
+{
+public:
+    explicit WorldPartition(Scene &scene) : scene(scene) {}
+    ~WorldPartition();
+
+    WorldPartition(const WorldPartition &) = delete;
+    WorldPartition &operator=(const WorldPartition &) = delete;
+
+    /**
+     * @brief Write every object of scene into directory, one file per occupied cell.
+     * @return False if a file couldn't be written.
+     */
+    static bool save(Scene &scene, const std::string &directory, float cellSize = 64.0f);
+
+    // Read the manifest written by save(). Nothing is loaded until update().
+    bool open(const std::string &directory);
+
+    // Start and finish loads and unloads for a viewer at position. Main thread only.
+    void update(const glm::vec3 &position);
+
+    // Remove every streamed object and forget the world
+    void close();
+
+    // Cells whose centre is closer than this get loaded; unloading waits for a further margin
+    void setLoadRadius(float radius) { loadRadius = radius; }
+    float getLoadRadius() const { return loadRadius; }
+
+    size_t getLoadedCellCount() const;
+
+private:
+    struct Cell
+    {
+        enum class State
+        {
+            Unloaded,
+            Loading,
+            Loaded
+        };
+
+        int x = 0;
+        int z = 0;
+        State state = State::Unloaded;
+        JobHandle job;
+        std::shared_ptr<SceneSnapshot> pending; // Filled by the loading job
+        std::vector<GameObjectHandle> objects;  // What the cell added to the scene
+        std::vector<uint64_t> objectIds;        // Ids of the last load, kept after unloading; they survive a snapshot restore
+    };
+
+    static uint64_t cellKey(int x, int z)
+    {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(z);
+    }
+
+    static std::string cellFileName(int x, int z);
+
+    float distanceTo(const Cell &cell, const glm::vec3 &position) const;
+    void startLoad(Cell &cell);
+    void unload(Cell &cell);
+
+    // The scene was cleared, maybe to restore a snapshot: find each cell's objects again by id
+    void rebindCells();
+
+    Scene &scene;
+    std::string directory;
+    float cellSize = 64.0f;
+    float loadRadius = 128.0f;
+    std::unordered_map<uint64_t, Cell> cells; // Every cell in the manifest
+    uint64_t seenResetCount = 0;              // Scene::getResetCount() as of the last update
+};
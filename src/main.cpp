@@ -10,7 +10,9 @@
 #include "renderer/renderer.h"
 #include "engine/scene.h"
 #include "engine/editor.h"
+#include "engine/world_partition.h"
 #include "engine/resourcemanager.h"
+#include "engine/jobs/job_system.h"
 #include "engine/components/meshrenderer.h"
 #include "engine/components/light.h"
 
@@ -28,6 +30,7 @@ struct EngineState
     bool quit = false;
     std::unique_ptr<Renderer> renderer;
     std::unique_ptr<Scene> activeScene;
+    std::unique_ptr<WorldPartition> world; // Set when started with a world directory
     std::unique_ptr<Editor> editor;
     bool mouseCaptured = false;
     int lastMouseX = 0;
@@ -120,6 +123,10 @@ int main(int argc, char **argv)
         // fprintf(stderr, "Failed to initialize OpenGL loader!\n");
         return ERROR_OGL_LOAD_FAILED;
     }
+    if (!Mesh::loadInstancing((GLADloadproc)SDL_GL_GetProcAddress))
+    {
+        LOG_WARNING("glVertexAttribDivisor not available, meshes will be drawn one by one");
+    }
 
     // Print OpenGL info
     LOG_INFO("OpenGL Version: {}", glGetString(GL_VERSION));
@@ -132,12 +139,12 @@ int main(int argc, char **argv)
     // printf("GLSL Version: %s\n", glGetString(GL_SHADING_LANGUAGE_VERSION));
 
     // Setup initial OpenGL state
-    glEnable(GL_DEPTH_TEST);
-    glDepthFunc(GL_LESS);
-    glEnable(GL_CULL_FACE);
-    glCullFace(GL_BACK);
-    glFrontFace(GL_CCW);
-    glEnable(GL_STENCIL_TEST); // Enable stencil testing globally
+    GL().enable(GL_DEPTH_TEST);
+    GL().depthFunc(GL_LESS);
+    GL().enable(GL_CULL_FACE);
+    GL().cullFace(GL_BACK);
+    GL().frontFace(GL_CCW);
+    GL().enable(GL_STENCIL_TEST); // Enable stencil testing globally
 
     // Initialize ImGui
     IMGUI_CHECKVERSION();
@@ -146,6 +153,7 @@ int main(int argc, char **argv)
     ImGui_ImplSDL2_InitForOpenGL(window, gl_context);
 
     // Initialize engine components
+    Jobs().initialize();
     g_state.renderer = std::make_unique<Renderer>();
     g_state.renderer->initialize(1280, 720);
     g_state.editor = std::make_unique<Editor>();
@@ -153,6 +161,16 @@ int main(int argc, char **argv)
     // Initialize scene
     initializeScene();
 
+    // A world directory written by WorldPartition::save streams in around the camera
+    if (argc > 1)
+    {
+        g_state.world = std::make_unique<WorldPartition>(*g_state.activeScene);
+        if (!g_state.world->open(argv[1]))
+        {
+            g_state.world.reset();
+        }
+    }
+
     while (!g_state.quit)
     {
         SDL_Event event;
@@ -224,6 +242,9 @@ int main(int argc, char **argv)
             }
         }
 
+        // GL().getStats() counts this frame's issued and skipped state calls
+        GL().resetStats();
+
         // Clear buffers
         glClearColor(0.1f, 0.1f, 0.1f, 1.00f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT); // Clear stencil buffer too
@@ -233,28 +254,34 @@ int main(int argc, char **argv)
         ImGui_ImplSDL2_NewFrame();
         ImGui::NewFrame();
 
+        // Frame boundary: bring in finished cells and drop distant ones before anything iterates the scene
+        if (g_state.world)
+        {
+            g_state.world->update(g_state.renderer->getCamera().getPosition());
+        }
+
         // Update editor
         g_state.editor->update();
 
         // Set up shader for scene rendering
         if (auto shader = g_state.renderer->getShader())
         {
-            shader->use();
+            Shader *instancedShader = Mesh::supportsInstancing() ? g_state.renderer->getInstancedShader() : nullptr;
 
-            // Set camera matrices
-            glm::mat4 projection = glm::perspective(glm::radians(45.0f),
-                                                    static_cast<float>(g_state.renderer->getWidth()) / g_state.renderer->getHeight(),
-                                                    0.1f, 100.0f);
-            shader->setMat4("projection", projection);
-            shader->setMat4("view", g_state.renderer->getCamera().getViewMatrix());
+            // Set camera matrices; the scene uploads them once for every shader
+            FrameUniforms camera;
+            camera.projection = glm::perspective(glm::radians(45.0f),
+                                                 static_cast<float>(g_state.renderer->getWidth()) / g_state.renderer->getHeight(),
+                                                 0.1f, 100.0f);
+            camera.view = g_state.renderer->getCamera().getViewMatrix();
 
             // Set camera position for specular lighting
-            shader->setVec3("viewPos", g_state.renderer->getCamera().getPosition());
+            camera.viewPos = glm::vec4(g_state.renderer->getCamera().getPosition(), 1.0f);
 
             // Render scene
             if (g_state.activeScene)
             {
-                g_state.activeScene->render(*shader, g_state.editor->getSelectedObject());
+                g_state.activeScene->render(*shader, camera, instancedShader);
             }
         }
 
@@ -262,14 +289,19 @@ int main(int argc, char **argv)
         ImGui::Render();
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 
+        // ImGui's backend restores what it changes, but not through the state cache
+        GL().invalidate();
+
         // Swap buffers
         SDL_GL_SwapWindow(window);
     }
 
     // Cleanup
+    g_state.world.reset();
     g_state.activeScene.reset();
     g_state.editor.reset();
     g_state.renderer.reset();
+    Jobs().shutdown();
 
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplSDL2_Shutdown();
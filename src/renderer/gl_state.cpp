@@ -0,0 +1,118 @@
+/**
+ * @file gl_state.cpp
+ * @brief Tracks bound GL state so redundant binds and state changes are never issued
+ */
+#include "gl_state.h"
+
+namespace
+{
+    // Bit in GLState's capability masks, or -1 for capabilities it doesn't track
+    int capabilityBit(GLenum capability)
+    {
+        switch (capability)
+        {
+        case GL_DEPTH_TEST:
+            return 0;
+        case GL_STENCIL_TEST:
+            return 1;
+        case GL_CULL_FACE:
+            return 2;
+        case GL_BLEND:
+            return 3;
+        case GL_SCISSOR_TEST:
+            return 4;
+        default:
+            return -1;
+        }
+    }
+}
+
+GLState &GL()
+{
+    static GLState state;
+    return state;
+}
+
+void GLState::setCapability(GLenum capability, bool enabled)
+{
+    int bit = capabilityBit(capability);
+    if (bit >= 0)
+    {
+        uint8_t mask = static_cast<uint8_t>(1u << bit);
+        if ((knownCapabilities & mask) && ((capabilities & mask) != 0) == enabled)
+        {
+            ++stats.skipped;
+            return;
+        }
+        knownCapabilities |= mask;
+        capabilities = enabled ? (capabilities | mask) : (capabilities & ~mask);
+    }
+
+    if (enabled)
+        glEnable(capability);
+    else
+        glDisable(capability);
+    ++stats.issued;
+}
+
+void GLState::deleteProgram(GLuint program)
+{
+    glDeleteProgram(program);
+    if (currentProgram == program)
+        currentProgram = Unknown;
+}
+
+void GLState::deleteVertexArray(GLuint vertexArray)
+{
+    glDeleteVertexArrays(1, &vertexArray);
+    if (currentVertexArray == vertexArray)
+        currentVertexArray = 0; // Deleting the bound VAO binds 0
+}
+
+void GLState::deleteBuffer(GLuint buffer)
+{
+    glDeleteBuffers(1, &buffer);
+
+    // Deleting a buffer resets every binding point it was attached to
+    if (arrayBuffer == buffer)
+        arrayBuffer = 0;
+    if (uniformBuffer == buffer)
+        uniformBuffer = 0;
+    for (IndexedBinding &binding : uniformBindings)
+    {
+        if (binding.buffer == buffer)
+            binding = {0, 0, WholeBuffer};
+    }
+}
+
+void GLState::deleteTexture(GLuint texture)
+{
+    glDeleteTextures(1, &texture);
+    for (GLuint &bound : textures)
+    {
+        if (bound == texture)
+            bound = 0;
+    }
+}
+
+void GLState::invalidate()
+{
+    currentProgram = Unknown;
+    currentVertexArray = Unknown;
+    arrayBuffer = Unknown;
+    uniformBuffer = Unknown;
+    currentTextureUnit = Unknown;
+    uniformBindings.fill(IndexedBinding{});
+    textures.fill(Unknown);
+    capabilities = 0;
+    knownCapabilities = 0;
+    currentDepthFunc = Unknown;
+    currentDepthMask = 0xFF;
+    currentCullFace = Unknown;
+    currentFrontFace = Unknown;
+    currentBlendFunc.fill(Unknown);
+    currentStencilFunc.fill(Unknown);
+    currentStencilOp.fill(Unknown);
+    currentStencilMask = ~0ull;
+    currentViewport.fill(-1);
+}
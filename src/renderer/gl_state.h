@@ -0,0 +1,254 @@
+/**
+ * @file gl_state.h
+ * @brief Tracks bound GL state so redundant binds and state changes are never issued
+ */
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include <glad/glad.h>
+
+/**
+ * @brief The renderer's view of the current GL state.
+ *
+ * Every bind, enable and state setter compares against what was last set through this
+ * class and skips the GL call when nothing would change. For the cache to stay right, all
+ * engine code must change tracked state through GL(), and delete objects through it too,
+ * since GL silently unbinds a deleted object and may hand its name out again. Code that
+ * changes state behind its back (e.g. a third-party renderer that doesn't restore it) must
+ * call invalidate() afterwards. Main thread only, like the GL context.
+ *
+ * Element array buffer bindings belong to the VAO and are not tracked.
+ */
+class GLState
+{
+public:
+    struct Stats
+    {
+        uint64_t issued = 0;  // Calls that reached GL
+        uint64_t skipped = 0; // Calls elided because the state already matched
+    };
+
+    static constexpr size_t MaxIndexedBindings = 8;
+    static constexpr size_t MaxTextureUnits = 16;
+
+    GLState() { invalidate(); }
+
+    void useProgram(GLuint program)
+    {
+        if (changed(currentProgram, program))
+            glUseProgram(program);
+    }
+
+    void bindVertexArray(GLuint vertexArray)
+    {
+        if (changed(currentVertexArray, vertexArray))
+            glBindVertexArray(vertexArray);
+    }
+
+    // GL_ARRAY_BUFFER or GL_UNIFORM_BUFFER; other targets pass straight through
+    void bindBuffer(GLenum target, GLuint buffer)
+    {
+        GLuint *slot = bufferSlot(target);
+        if (!slot)
+        {
+            glBindBuffer(target, buffer);
+            ++stats.issued;
+            return;
+        }
+        if (changed(*slot, buffer))
+            glBindBuffer(target, buffer);
+    }
+
+    // Indexed uniform buffer bindings. Both also set the generic GL_UNIFORM_BUFFER binding.
+    void bindUniformBufferBase(GLuint index, GLuint buffer)
+    {
+        bindUniformBufferRange(index, buffer, 0, WholeBuffer);
+    }
+
+    void bindUniformBufferRange(GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+    {
+        IndexedBinding wanted{buffer, offset, size};
+        if (index < MaxIndexedBindings && uniformBindings[index] == wanted)
+        {
+            ++stats.skipped;
+            return;
+        }
+
+        if (size == WholeBuffer)
+            glBindBufferBase(GL_UNIFORM_BUFFER, index, buffer);
+        else
+            glBindBufferRange(GL_UNIFORM_BUFFER, index, buffer, offset, size);
+        ++stats.issued;
+
+        if (index < MaxIndexedBindings)
+            uniformBindings[index] = wanted;
+        uniformBuffer = buffer;
+    }
+
+    void bindTexture(GLuint unit, GLenum target, GLuint texture)
+    {
+        if (unit >= MaxTextureUnits || target != GL_TEXTURE_2D)
+        {
+            activeTexture(unit);
+            glBindTexture(target, texture);
+            ++stats.issued;
+            return;
+        }
+        if (textures[unit] == texture)
+        {
+            ++stats.skipped;
+            return;
+        }
+        activeTexture(unit);
+        glBindTexture(target, texture);
+        textures[unit] = texture;
+        ++stats.issued;
+    }
+
+    // GL_DEPTH_TEST, GL_STENCIL_TEST, GL_CULL_FACE, GL_BLEND or GL_SCISSOR_TEST
+    void enable(GLenum capability) { setCapability(capability, true); }
+    void disable(GLenum capability) { setCapability(capability, false); }
+
+    void depthFunc(GLenum func)
+    {
+        if (changed(currentDepthFunc, func))
+            glDepthFunc(func);
+    }
+
+    void depthMask(bool write)
+    {
+        if (changed(currentDepthMask, static_cast<GLboolean>(write ? GL_TRUE : GL_FALSE)))
+            glDepthMask(write ? GL_TRUE : GL_FALSE);
+    }
+
+    void cullFace(GLenum face)
+    {
+        if (changed(currentCullFace, face))
+            glCullFace(face);
+    }
+
+    void frontFace(GLenum direction)
+    {
+        if (changed(currentFrontFace, direction))
+            glFrontFace(direction);
+    }
+
+    void blendFunc(GLenum source, GLenum destination)
+    {
+        if (changed(currentBlendFunc, {source, destination}))
+            glBlendFunc(source, destination);
+    }
+
+    void stencilFunc(GLenum func, GLint ref, GLuint mask)
+    {
+        if (changed(currentStencilFunc, {func, static_cast<GLuint>(ref), mask}))
+            glStencilFunc(func, ref, mask);
+    }
+
+    void stencilOp(GLenum stencilFail, GLenum depthFail, GLenum pass)
+    {
+        if (changed(currentStencilOp, {stencilFail, depthFail, pass}))
+            glStencilOp(stencilFail, depthFail, pass);
+    }
+
+    void stencilMask(GLuint mask)
+    {
+        if (changed(currentStencilMask, static_cast<uint64_t>(mask)))
+            glStencilMask(mask);
+    }
+
+    void viewport(GLint x, GLint y, GLsizei width, GLsizei height)
+    {
+        if (changed(currentViewport, {x, y, width, height}))
+            glViewport(x, y, width, height);
+    }
+
+    // Deleting through these keeps the cache from treating a reused name as still bound
+    void deleteProgram(GLuint program);
+    void deleteVertexArray(GLuint vertexArray);
+    void deleteBuffer(GLuint buffer);
+    void deleteTexture(GLuint texture);
+
+    // Forget everything; the next call of each kind always reaches GL
+    void invalidate();
+
+    const Stats &getStats() const { return stats; }
+    void resetStats() { stats = {}; }
+
+private:
+    static constexpr GLsizeiptr WholeBuffer = -1;
+    static constexpr GLuint Unknown = ~0u;
+
+    struct IndexedBinding
+    {
+        GLuint buffer = Unknown;
+        GLintptr offset = 0;
+        GLsizeiptr size = 0;
+
+        bool operator==(const IndexedBinding &other) const
+        {
+            return buffer == other.buffer && offset == other.offset && size == other.size;
+        }
+    };
+
+    // Store value and return true if it differs from current, counting either way
+    template <typename T>
+    bool changed(T &current, const T &value)
+    {
+        if (current == value)
+        {
+            ++stats.skipped;
+            return false;
+        }
+        current = value;
+        ++stats.issued;
+        return true;
+    }
+
+    GLuint *bufferSlot(GLenum target)
+    {
+        switch (target)
+        {
+        case GL_ARRAY_BUFFER:
+            return &arrayBuffer;
+        case GL_UNIFORM_BUFFER:
+            return &uniformBuffer;
+        default:
+            return nullptr;
+        }
+    }
+
+    void activeTexture(GLuint unit)
+    {
+        if (changed(currentTextureUnit, unit))
+            glActiveTexture(GL_TEXTURE0 + unit);
+    }
+
+    void setCapability(GLenum capability, bool enabled);
+
+    // invalidate() sets every value to Unknown or similar, which no real call passes
+    GLuint currentProgram;
+    GLuint currentVertexArray;
+    GLuint arrayBuffer;
+    GLuint uniformBuffer;
+    GLuint currentTextureUnit;
+    std::array<IndexedBinding, MaxIndexedBindings> uniformBindings;
+    std::array<GLuint, MaxTextureUnits> textures;
+    uint8_t capabilities;      // Enabled bits, see setCapability
+    uint8_t knownCapabilities; // Which of those bits have been set since invalidate()
+    GLenum currentDepthFunc;
+    GLboolean currentDepthMask;
+    GLenum currentCullFace;
+    GLenum currentFrontFace;
+    std::array<GLenum, 2> currentBlendFunc;
+    std::array<GLuint, 3> currentStencilFunc;
+    std::array<GLenum, 3> currentStencilOp;
+    uint64_t currentStencilMask; // Wider than GLuint so Unknown can't collide with ~0u
+    std::array<GLint, 4> currentViewport;
+    Stats stats;
+};
+
+// The GL state cache for the main thread's context
+GLState &GL();
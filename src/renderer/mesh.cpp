@@ -2,8 +2,11 @@
  * @file mesh.cpp
  * @brief Mesh class for handling mesh data
  */
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
 #include <stdio.h>
+#include <utility>
 
 #include <glad/glad.h>
 
@@ -13,6 +16,28 @@
 #define M_PI 3.14159265358979323846
 #endif
 
+namespace
+{
+    typedef void(APIENTRYP VertexAttribDivisorProc)(GLuint index, GLuint divisor);
+    VertexAttribDivisorProc vertexAttribDivisor = nullptr;
+}
+
+bool Mesh::loadInstancing(GLADloadproc load)
+{
+    vertexAttribDivisor = reinterpret_cast<VertexAttribDivisorProc>(load("glVertexAttribDivisor"));
+    if (!vertexAttribDivisor)
+    {
+        // Same function from GL_ARB_instanced_arrays on older drivers
+        vertexAttribDivisor = reinterpret_cast<VertexAttribDivisorProc>(load("glVertexAttribDivisorARB"));
+    }
+    return vertexAttribDivisor != nullptr;
+}
+
+bool Mesh::supportsInstancing()
+{
+    return vertexAttribDivisor != nullptr;
+}
+
 // Helper function to check OpenGL errors
 void checkGLError(const char *location)
 {
@@ -23,7 +48,13 @@ void checkGLError(const char *location)
     }
 }
 
+namespace
+{
+    uint32_t nextSortId = 0;
+}
+
 Mesh::Mesh(const std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices)
+    : sortId(nextSortId++)
 {
     setupMesh(vertices, indices);
 }
@@ -34,7 +65,9 @@ Mesh::~Mesh()
 }
 
 Mesh::Mesh(Mesh &&other) noexcept
-    : VAO(other.VAO), VBO(other.VBO), EBO(other.EBO), indexCount(other.indexCount)
+    : VAO(other.VAO), VBO(other.VBO), EBO(other.EBO), indexCount(other.indexCount), sortId(other.sortId),
+      bounds(other.bounds), boundingSphere(other.boundingSphere), positions(std::move(other.positions)),
+      triangleIndices(std::move(other.triangleIndices))
 {
     other.VAO = 0;
     other.VBO = 0;
@@ -52,6 +85,11 @@ Mesh &Mesh::operator=(Mesh &&other) noexcept
         VBO = other.VBO;
         EBO = other.EBO;
         indexCount = other.indexCount;
+        sortId = other.sortId;
+        bounds = other.bounds;
+        boundingSphere = other.boundingSphere;
+        positions = std::move(other.positions);
+        triangleIndices = std::move(other.triangleIndices);
 
         other.VAO = 0;
         other.VBO = 0;
@@ -63,9 +101,46 @@ Mesh &Mesh::operator=(Mesh &&other) noexcept
 
 void Mesh::Draw() const
 {
-    glBindVertexArray(VAO);
+    // Left bound; the state cache skips the bind when the next draw uses the same mesh
+    bind();
     glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
+}
+
+void Mesh::drawBound() const
+{
+    glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0);
+}
+
+void Mesh::setInstanceBuffer(GLuint buffer, size_t firstInstance) const
+{
+    GL().bindBuffer(GL_ARRAY_BUFFER, buffer);
+    size_t base = firstInstance * sizeof(InstanceData);
+
+    // A matrix attribute takes one location per column
+    for (GLuint column = 0; column < 4; ++column)
+    {
+        GLuint location = 2 + column;
+        glEnableVertexAttribArray(location);
+        glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+                              (void *)(base + offsetof(InstanceData, Model) + column * sizeof(glm::vec4)));
+        vertexAttribDivisor(location, 1);
+    }
+    for (GLuint column = 0; column < 3; ++column)
+    {
+        GLuint location = 6 + column;
+        glEnableVertexAttribArray(location);
+        glVertexAttribPointer(location, 3, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+                              (void *)(base + offsetof(InstanceData, NormalMatrix) + column * sizeof(glm::vec3)));
+        vertexAttribDivisor(location, 1);
+    }
+    glEnableVertexAttribArray(9);
+    glVertexAttribPointer(9, 3, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void *)(base + offsetof(InstanceData, Color)));
+    vertexAttribDivisor(9, 1);
+}
+
+void Mesh::drawInstancedBound(size_t instanceCount) const
+{
+    glDrawElementsInstanced(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0, static_cast<GLsizei>(instanceCount));
 }
 
 Mesh Mesh::CreateCube()
@@ -175,6 +250,14 @@ Mesh Mesh::CreateSphere(float radius, unsigned int segments)
 bool Mesh::setupMesh(const std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices)
 {
     indexCount = indices.size();
+    computeBounds(vertices);
+
+    positions.reserve(vertices.size());
+    for (const Vertex &vertex : vertices)
+    {
+        positions.push_back(vertex.Position);
+    }
+    triangleIndices.assign(indices.begin(), indices.end());
 
     // Create buffers/arrays
     glGenVertexArrays(1, &VAO);
@@ -186,11 +269,11 @@ bool Mesh::setupMesh(const std::vector<Vertex> &vertices, const std::vector<unsi
     glGenBuffers(1, &EBO);
     checkGLError("glGenBuffers EBO");
 
-    glBindVertexArray(VAO);
+    GL().bindVertexArray(VAO);
     checkGLError("glBindVertexArray");
 
     // Load data into vertex buffer
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    GL().bindBuffer(GL_ARRAY_BUFFER, VBO);
     glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data(), GL_STATIC_DRAW);
     checkGLError("glBufferData VBO");
 
@@ -210,25 +293,53 @@ bool Mesh::setupMesh(const std::vector<Vertex> &vertices, const std::vector<unsi
     glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, Normal));
     checkGLError("Normal attribute");
 
-    glBindVertexArray(0);
+    // So a later GL_ELEMENT_ARRAY_BUFFER bind can't end up in this mesh's VAO
+    GL().bindVertexArray(0);
     return true;
 }
 
+void Mesh::computeBounds(const std::vector<Vertex> &vertices)
+{
+    if (vertices.empty())
+    {
+        bounds = {};
+        boundingSphere = {};
+        return;
+    }
+
+    bounds.min = bounds.max = vertices[0].Position;
+    for (const Vertex &vertex : vertices)
+    {
+        bounds.min = glm::min(bounds.min, vertex.Position);
+        bounds.max = glm::max(bounds.max, vertex.Position);
+    }
+
+    // Centred on the box rather than minimal, so culling can test both around one centre
+    boundingSphere.center = bounds.getCenter();
+    float radiusSquared = 0.0f;
+    for (const Vertex &vertex : vertices)
+    {
+        glm::vec3 offset = vertex.Position - boundingSphere.center;
+        radiusSquared = std::max(radiusSquared, glm::dot(offset, offset));
+    }
+    boundingSphere.radius = std::sqrt(radiusSquared);
+}
+
 void Mesh::cleanup()
 {
     if (VAO != 0)
     {
-        glDeleteVertexArrays(1, &VAO);
+        GL().deleteVertexArray(VAO);
         VAO = 0;
     }
     if (VBO != 0)
     {
-        glDeleteBuffers(1, &VBO);
+        GL().deleteBuffer(VBO);
         VBO = 0;
     }
     if (EBO != 0)
     {
-        glDeleteBuffers(1, &EBO);
+        GL().deleteBuffer(EBO);
         EBO = 0;
     }
 }
@@ -3,17 +3,29 @@
  * @brief Mesh class for handling mesh data
  */
 #pragma once
+#include <cstdint>
 #include <vector>
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
+#include "gl_state.h"
+#include "../engine/math/bounds.h"
+
 struct Vertex
 {
     glm::vec3 Position;
     glm::vec3 Normal;
 };
 
+// Per-instance vertex data read by basic_instanced.vert
+struct InstanceData
+{
+    glm::mat4 Model;
+    glm::mat3 NormalMatrix;
+    glm::vec3 Color;
+};
+
 class Mesh
 {
 public:
@@ -29,6 +41,33 @@ public:
     Mesh &operator=(Mesh &&other) noexcept;
 
     void Draw() const;
+
+    // For drawing the same mesh several times in a row: bind once, then drawBound() each time
+    void bind() const { GL().bindVertexArray(VAO); }
+    void drawBound() const;
+    static void unbind() { GL().bindVertexArray(0); }
+
+    // The bundled glad loader stops at GL 3.2, so the one 3.3 entry point instancing needs is
+    // loaded here. Call after gladLoadGLLoader with the same loader; false if the driver lacks it.
+    static bool loadInstancing(GLADloadproc load);
+    static bool supportsInstancing();
+
+    // Point this mesh's instance attributes at InstanceData in buffer, starting at firstInstance.
+    // The mesh must be bound and supportsInstancing() true.
+    void setInstanceBuffer(GLuint buffer, size_t firstInstance) const;
+    void drawInstancedBound(size_t instanceCount) const;
+
+    // Small per-mesh number the render queue groups draws by
+    uint32_t getSortId() const { return sortId; }
+
+    // Local-space bounds of the vertices; the sphere is centred on the box
+    const BoundingBox &getBounds() const { return bounds; }
+    const BoundingSphere &getBoundingSphere() const { return boundingSphere; }
+
+    // CPU copy of the triangles, for the software occlusion rasterizer
+    const std::vector<glm::vec3> &getPositions() const { return positions; }
+    const std::vector<uint32_t> &getIndices() const { return triangleIndices; }
+
     static Mesh CreateCube();
     static Mesh CreateSphere(float radius, unsigned int segments);
 
@@ -37,8 +76,14 @@ public:
 
 private:
     bool setupMesh(const std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices);
+    void computeBounds(const std::vector<Vertex> &vertices);
     void cleanup();
 
     GLuint VAO{0}, VBO{0}, EBO{0};
     size_t indexCount{0};
+    uint32_t sortId;
+    BoundingBox bounds;
+    BoundingSphere boundingSphere;
+    std::vector<glm::vec3> positions;
+    std::vector<uint32_t> triangleIndices;
 };
@@ -0,0 +1,567 @@
+/**
+ * @file occlusion_buffer.cpp
+ * @brief Low resolution software depth buffer for culling objects hidden behind occluders
+ */
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include "occlusion_buffer.h"
+#include "mesh.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OCCLUSION_SSE 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// The AVX2 loops are compiled into every x86 build but only run once the CPU is known to
+// have AVX2, so GCC and Clang need them marked rather than the whole build
+#if defined(OCCLUSION_SSE) && (defined(__GNUC__) || defined(__clang__))
+#define OCCLUSION_AVX2 1
+#define AVX2_TARGET __attribute__((target("avx2")))
+#elif defined(OCCLUSION_SSE) && defined(_MSC_VER)
+#define OCCLUSION_AVX2 1
+#define AVX2_TARGET
+#endif
+
+namespace
+{
+    enum class InstructionSet
+    {
+        Scalar,
+        Sse,
+        Avx2
+    };
+
+    InstructionSet detectInstructionSet()
+    {
+#if defined(OCCLUSION_AVX2) && defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7)
+            return InstructionSet::Sse;
+
+        // AVX registers are only usable if the OS saves them on context switches
+        __cpuid(info, 1);
+        bool osSavesAvx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6;
+        __cpuidex(info, 7, 0);
+        return osSavesAvx && (info[1] & (1 << 5)) ? InstructionSet::Avx2 : InstructionSet::Sse;
+#elif defined(OCCLUSION_AVX2)
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") ? InstructionSet::Avx2 : InstructionSet::Sse;
+#else
+        return InstructionSet::Scalar;
+#endif
+    }
+
+    InstructionSet instructionSet()
+    {
+        static const InstructionSet detected = detectInstructionSet();
+        return detected;
+    }
+
+    constexpr int Width = OcclusionBuffer::Width;
+    constexpr int Height = OcclusionBuffer::Height;
+    constexpr int TileWidth = OcclusionBuffer::TileWidth;
+    constexpr int TileHeight = OcclusionBuffer::TileHeight;
+    constexpr int TilesX = OcclusionBuffer::TilesX;
+    constexpr int TilesY = OcclusionBuffer::TilesY;
+    static_assert(Width % 8 == 0 && TileWidth == 8, "Spans and tile rows are loaded 8 pixels at a time");
+
+    // Edge equations and depth plane of a triangle, all in pixels. A pixel centre (x, y)
+    // is inside when every edge's a * x + b * y + c is non-negative.
+    struct Triangle
+    {
+        float edgeA[3];
+        float edgeB[3];
+        float edgeC[3];
+        float depthX, depthY, depthC; // depth = depthX * x + depthY * y + depthC
+        int minX, maxX, minY, maxY;   // minX is rounded down to a multiple of 8
+    };
+
+    // Triangles are clipped in clip space against the near plane, and against a band
+    // around the screen so the edge equations stay well within float precision
+    constexpr float GuardBand = 2.0f;
+    constexpr int ClipPlaneCount = 5;
+    const glm::vec4 ClipPlanes[ClipPlaneCount] = {
+        {0.0f, 0.0f, 1.0f, 1.0f},
+        {-1.0f, 0.0f, 0.0f, GuardBand},
+        {1.0f, 0.0f, 0.0f, GuardBand},
+        {0.0f, -1.0f, 0.0f, GuardBand},
+        {0.0f, 1.0f, 0.0f, GuardBand},
+    };
+    constexpr int MaxClippedVertices = 3 + ClipPlaneCount; // Each plane adds at most one
+
+    glm::vec3 toScreen(const glm::vec4 &clip)
+    {
+        glm::vec3 ndc = glm::vec3(clip) / clip.w;
+        return {(ndc.x * 0.5f + 0.5f) * Width, (ndc.y * 0.5f + 0.5f) * Height, ndc.z * 0.5f + 0.5f};
+    }
+
+    void rasterizeScalar(const Triangle &t, float *depth)
+    {
+        for (int y = t.minY; y <= t.maxY; ++y)
+        {
+            float py = y + 0.5f;
+            float *row = depth + y * Width;
+            for (int x = t.minX; x <= t.maxX; ++x)
+            {
+                float px = x + 0.5f;
+                bool inside = true;
+                for (int e = 0; e < 3; ++e)
+                {
+                    inside &= t.edgeA[e] * px + t.edgeB[e] * py + t.edgeC[e] >= 0.0f;
+                }
+                if (inside)
+                    row[x] = std::min(row[x], t.depthX * px + t.depthY * py + t.depthC);
+            }
+        }
+    }
+
+    void buildTilesScalar(const float *depth, float *tiles)
+    {
+        for (int ty = 0; ty < TilesY; ++ty)
+        {
+            for (int tx = 0; tx < TilesX; ++tx)
+            {
+                float farthest = 0.0f;
+                for (int y = ty * TileHeight; y < (ty + 1) * TileHeight; ++y)
+                {
+                    const float *row = depth + y * Width + tx * TileWidth;
+                    farthest = std::max(farthest, *std::max_element(row, row + TileWidth));
+                }
+                tiles[ty * TilesX + tx] = farthest;
+            }
+        }
+    }
+
+    // True if any tile in the inclusive range has nothing nearer than depth
+    bool anyTileBehindScalar(const float *tiles, int tx0, int tx1, int ty0, int ty1, float depth)
+    {
+        for (int ty = ty0; ty <= ty1; ++ty)
+        {
+            for (int tx = tx0; tx <= tx1; ++tx)
+            {
+                if (tiles[ty * TilesX + tx] >= depth)
+                    return true;
+            }
+        }
+        return false;
+    }
+
+#ifdef OCCLUSION_SSE
+    float horizontalMax(__m128 v)
+    {
+        v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+        v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_cvtss_f32(v);
+    }
+
+    void rasterizeSse(const Triangle &t, float *depth)
+    {
+        const __m128 laneCentres = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+        __m128 edgeA[3];
+        for (int e = 0; e < 3; ++e)
+        {
+            edgeA[e] = _mm_set1_ps(t.edgeA[e]);
+        }
+        __m128 depthX = _mm_set1_ps(t.depthX);
+
+        for (int y = t.minY; y <= t.maxY; ++y)
+        {
+            float py = y + 0.5f;
+            __m128 rowEdge[3];
+            for (int e = 0; e < 3; ++e)
+            {
+                rowEdge[e] = _mm_set1_ps(t.edgeB[e] * py + t.edgeC[e]);
+            }
+            __m128 rowDepth = _mm_set1_ps(t.depthY * py + t.depthC);
+            float *row = depth + y * Width;
+
+            for (int x = t.minX; x <= t.maxX; x += 4)
+            {
+                __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), laneCentres);
+
+                // A lane is outside if any edge value is negative, i.e. has its sign bit set
+                __m128 outside = _mm_add_ps(_mm_mul_ps(edgeA[0], px), rowEdge[0]);
+                outside = _mm_or_ps(outside, _mm_add_ps(_mm_mul_ps(edgeA[1], px), rowEdge[1]));
+                outside = _mm_or_ps(outside, _mm_add_ps(_mm_mul_ps(edgeA[2], px), rowEdge[2]));
+                if (_mm_movemask_ps(outside) == 0xF)
+                    continue;
+
+                // Spread each sign bit over its lane to mask the depth write
+                __m128 keep = _mm_castsi128_ps(_mm_srai_epi32(_mm_castps_si128(outside), 31));
+                __m128 current = _mm_loadu_ps(row + x);
+                __m128 nearer = _mm_min_ps(current, _mm_add_ps(_mm_mul_ps(depthX, px), rowDepth));
+                _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(keep, current), _mm_andnot_ps(keep, nearer)));
+            }
+        }
+    }
+
+    void buildTilesSse(const float *depth, float *tiles)
+    {
+        for (int ty = 0; ty < TilesY; ++ty)
+        {
+            const float *rows = depth + ty * TileHeight * Width;
+            for (int tx = 0; tx < TilesX; ++tx)
+            {
+                const float *tile = rows + tx * TileWidth;
+                __m128 farthest = _mm_max_ps(_mm_loadu_ps(tile), _mm_loadu_ps(tile + 4));
+                for (int y = 1; y < TileHeight; ++y)
+                {
+                    farthest = _mm_max_ps(farthest, _mm_loadu_ps(tile + y * Width));
+                    farthest = _mm_max_ps(farthest, _mm_loadu_ps(tile + y * Width + 4));
+                }
+                tiles[ty * TilesX + tx] = horizontalMax(farthest);
+            }
+        }
+    }
+
+    bool anyTileBehindSse(const float *tiles, int tx0, int tx1, int ty0, int ty1, float depth)
+    {
+        __m128 threshold = _mm_set1_ps(depth);
+        for (int ty = ty0; ty <= ty1; ++ty)
+        {
+            const float *row = tiles + ty * TilesX;
+            int tx = tx0;
+            for (; tx + 3 <= tx1; tx += 4)
+            {
+                if (_mm_movemask_ps(_mm_cmpge_ps(_mm_loadu_ps(row + tx), threshold)))
+                    return true;
+            }
+            for (; tx <= tx1; ++tx)
+            {
+                if (row[tx] >= depth)
+                    return true;
+            }
+        }
+        return false;
+    }
+#endif
+
+#ifdef OCCLUSION_AVX2
+    AVX2_TARGET void rasterizeAvx2(const Triangle &t, float *depth)
+    {
+        const __m256 laneCentres = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+        __m256 edgeA[3];
+        for (int e = 0; e < 3; ++e)
+        {
+            edgeA[e] = _mm256_set1_ps(t.edgeA[e]);
+        }
+        __m256 depthX = _mm256_set1_ps(t.depthX);
+
+        for (int y = t.minY; y <= t.maxY; ++y)
+        {
+            float py = y + 0.5f;
+            __m256 rowEdge[3];
+            for (int e = 0; e < 3; ++e)
+            {
+                rowEdge[e] = _mm256_set1_ps(t.edgeB[e] * py + t.edgeC[e]);
+            }
+            __m256 rowDepth = _mm256_set1_ps(t.depthY * py + t.depthC);
+            float *row = depth + y * Width;
+
+            for (int x = t.minX; x <= t.maxX; x += 8)
+            {
+                __m256 px = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(x)), laneCentres);
+
+                // Same sign-bit mask as the SSE loop; blendv reads the sign bits directly
+                __m256 outside = _mm256_add_ps(_mm256_mul_ps(edgeA[0], px), rowEdge[0]);
+                outside = _mm256_or_ps(outside, _mm256_add_ps(_mm256_mul_ps(edgeA[1], px), rowEdge[1]));
+                outside = _mm256_or_ps(outside, _mm256_add_ps(_mm256_mul_ps(edgeA[2], px), rowEdge[2]));
+                if (_mm256_movemask_ps(outside) == 0xFF)
+                    continue;
+
+                __m256 current = _mm256_loadu_ps(row + x);
+                __m256 nearer = _mm256_min_ps(current, _mm256_add_ps(_mm256_mul_ps(depthX, px), rowDepth));
+                _mm256_storeu_ps(row + x, _mm256_blendv_ps(nearer, current, outside));
+            }
+        }
+    }
+
+    AVX2_TARGET void buildTilesAvx2(const float *depth, float *tiles)
+    {
+        for (int ty = 0; ty < TilesY; ++ty)
+        {
+            const float *rows = depth + ty * TileHeight * Width;
+            for (int tx = 0; tx < TilesX; ++tx)
+            {
+                // One tile row per register
+                const float *tile = rows + tx * TileWidth;
+                __m256 farthest = _mm256_loadu_ps(tile);
+                for (int y = 1; y < TileHeight; ++y)
+                {
+                    farthest = _mm256_max_ps(farthest, _mm256_loadu_ps(tile + y * Width));
+                }
+                __m128 half = _mm_max_ps(_mm256_castps256_ps128(farthest), _mm256_extractf128_ps(farthest, 1));
+                tiles[ty * TilesX + tx] = horizontalMax(half);
+            }
+        }
+    }
+
+    AVX2_TARGET bool anyTileBehindAvx2(const float *tiles, int tx0, int tx1, int ty0, int ty1, float depth)
+    {
+        __m256 threshold = _mm256_set1_ps(depth);
+        for (int ty = ty0; ty <= ty1; ++ty)
+        {
+            const float *row = tiles + ty * TilesX;
+            int tx = tx0;
+            for (; tx + 7 <= tx1; tx += 8)
+            {
+                if (_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(row + tx), threshold, _CMP_GE_OQ)))
+                    return true;
+            }
+            for (; tx <= tx1; ++tx)
+            {
+                if (row[tx] >= depth)
+                    return true;
+            }
+        }
+        return false;
+    }
+#endif
+}
+
+OcclusionBuffer::OcclusionBuffer()
+    : depth(static_cast<size_t>(Width) * Height, 1.0f), tiles(static_cast<size_t>(TilesX) * TilesY, 1.0f)
+{
+}
+
+const char *OcclusionBuffer::getInstructionSet()
+{
+    switch (instructionSet())
+    {
+    case InstructionSet::Avx2:
+        return "AVX2";
+    case InstructionSet::Sse:
+        return "SSE";
+    default:
+        return "scalar";
+    }
+}
+
+void OcclusionBuffer::begin(const glm::mat4 &camera)
+{
+    viewProjection = camera;
+    std::fill(depth.begin(), depth.end(), 1.0f);
+    std::fill(tiles.begin(), tiles.end(), 1.0f);
+    triangleCount = 0;
+}
+
+void OcclusionBuffer::rasterize(const Mesh &mesh, const glm::mat4 &model)
+{
+    const std::vector<glm::vec3> &positions = mesh.getPositions();
+    const std::vector<uint32_t> &indices = mesh.getIndices();
+
+    glm::mat4 transform = viewProjection * model;
+    clipPositions.resize(positions.size());
+    for (size_t i = 0; i < positions.size(); ++i)
+    {
+        clipPositions[i] = transform * glm::vec4(positions[i], 1.0f);
+    }
+
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        const glm::vec4 &a = clipPositions[indices[i]];
+        const glm::vec4 &b = clipPositions[indices[i + 1]];
+        const glm::vec4 &c = clipPositions[indices[i + 2]];
+
+        // Skip triangles entirely off one side of the view volume
+        bool offscreen = false;
+        for (int axis = 0; axis < 3 && !offscreen; ++axis)
+        {
+            offscreen = (a[axis] > a.w && b[axis] > b.w && c[axis] > c.w) ||
+                        (a[axis] < -a.w && b[axis] < -b.w && c[axis] < -c.w);
+        }
+        if (offscreen)
+            continue;
+
+        // Only clip against the planes the triangle actually crosses
+        int crossed = 0;
+        for (int p = 0; p < ClipPlaneCount; ++p)
+        {
+            int behind = (glm::dot(ClipPlanes[p], a) < 0.0f) + (glm::dot(ClipPlanes[p], b) < 0.0f) +
+                         (glm::dot(ClipPlanes[p], c) < 0.0f);
+            if (behind == 3)
+            {
+                offscreen = true;
+                break;
+            }
+            if (behind)
+                crossed |= 1 << p;
+        }
+        if (offscreen)
+            continue;
+
+        if (!crossed)
+        {
+            rasterizeTriangle(toScreen(a), toScreen(b), toScreen(c));
+            continue;
+        }
+
+        // Sutherland-Hodgman, one plane at a time, then fan out the remaining polygon
+        glm::vec4 polygon[MaxClippedVertices] = {a, b, c};
+        glm::vec4 clipped[MaxClippedVertices];
+        int count = 3;
+        for (int p = 0; p < ClipPlaneCount && count >= 3; ++p)
+        {
+            if (!(crossed & (1 << p)))
+                continue;
+
+            int kept = 0;
+            for (int v = 0; v < count; ++v)
+            {
+                const glm::vec4 &current = polygon[v];
+                const glm::vec4 &next = polygon[(v + 1) % count];
+                float currentDistance = glm::dot(ClipPlanes[p], current);
+                float nextDistance = glm::dot(ClipPlanes[p], next);
+                if (currentDistance >= 0.0f)
+                    clipped[kept++] = current;
+                if ((currentDistance >= 0.0f) != (nextDistance >= 0.0f))
+                    clipped[kept++] = current + (next - current) * (currentDistance / (currentDistance - nextDistance));
+            }
+            std::copy(clipped, clipped + kept, polygon);
+            count = kept;
+        }
+
+        if (count < 3)
+            continue;
+        glm::vec3 first = toScreen(polygon[0]);
+        glm::vec3 previous = toScreen(polygon[1]);
+        for (int v = 2; v < count; ++v)
+        {
+            glm::vec3 current = toScreen(polygon[v]);
+            rasterizeTriangle(first, previous, current);
+            previous = current;
+        }
+    }
+}
+
+void OcclusionBuffer::rasterizeTriangle(glm::vec3 v0, glm::vec3 v1, glm::vec3 v2)
+{
+    float area = (v1.x - v0.x) * (v2.y - v0.y) - (v2.x - v0.x) * (v1.y - v0.y);
+    if (!(std::abs(area) > 1e-6f))
+        return; // Degenerate, or NaN from a vertex at w = 0
+
+    // Both windings are drawn, so occluders need not be closed or consistently wound
+    if (area < 0.0f)
+    {
+        std::swap(v1, v2);
+        area = -area;
+    }
+
+    // Pixels whose centre lies within the triangle's bounds
+    Triangle t;
+    t.minX = std::max(0, static_cast<int>(std::ceil(std::min({v0.x, v1.x, v2.x}) - 0.5f)));
+    t.maxX = std::min(Width - 1, static_cast<int>(std::floor(std::max({v0.x, v1.x, v2.x}) - 0.5f)));
+    t.minY = std::max(0, static_cast<int>(std::ceil(std::min({v0.y, v1.y, v2.y}) - 0.5f)));
+    t.maxY = std::min(Height - 1, static_cast<int>(std::floor(std::max({v0.y, v1.y, v2.y}) - 0.5f)));
+    if (t.minX > t.maxX || t.minY > t.maxY)
+        return;
+    t.minX &= ~7; // Spans start on a full register; the extra pixels fail the edge tests
+
+    const glm::vec3 *vertices[3] = {&v0, &v1, &v2};
+    for (int e = 0; e < 3; ++e)
+    {
+        const glm::vec3 &from = *vertices[e];
+        const glm::vec3 &to = *vertices[(e + 1) % 3];
+        t.edgeA[e] = from.y - to.y;
+        t.edgeB[e] = to.x - from.x;
+        t.edgeC[e] = -(t.edgeA[e] * from.x + t.edgeB[e] * from.y);
+    }
+
+    t.depthX = ((v1.z - v0.z) * (v2.y - v0.y) - (v2.z - v0.z) * (v1.y - v0.y)) / area;
+    t.depthY = ((v2.z - v0.z) * (v1.x - v0.x) - (v1.z - v0.z) * (v2.x - v0.x)) / area;
+    t.depthC = v0.z - t.depthX * v0.x - t.depthY * v0.y;
+    ++triangleCount;
+
+    switch (instructionSet())
+    {
+#ifdef OCCLUSION_AVX2
+    case InstructionSet::Avx2:
+        rasterizeAvx2(t, depth.data());
+        break;
+#endif
+#ifdef OCCLUSION_SSE
+    case InstructionSet::Sse:
+        rasterizeSse(t, depth.data());
+        break;
+#endif
+    default:
+        rasterizeScalar(t, depth.data());
+        break;
+    }
+}
+
+void OcclusionBuffer::finish()
+{
+    switch (instructionSet())
+    {
+#ifdef OCCLUSION_AVX2
+    case InstructionSet::Avx2:
+        buildTilesAvx2(depth.data(), tiles.data());
+        break;
+#endif
+#ifdef OCCLUSION_SSE
+    case InstructionSet::Sse:
+        buildTilesSse(depth.data(), tiles.data());
+        break;
+#endif
+    default:
+        buildTilesScalar(depth.data(), tiles.data());
+        break;
+    }
+}
+
+bool OcclusionBuffer::isVisible(const BoundingBox &box) const
+{
+    // Screen rectangle and nearest depth of the box's corners
+    float infinity = std::numeric_limits<float>::infinity();
+    glm::vec2 screenMin(infinity);
+    glm::vec2 screenMax(-infinity);
+    float nearest = infinity;
+    for (int corner = 0; corner < 8; ++corner)
+    {
+        glm::vec3 position((corner & 1) ? box.max.x : box.min.x, (corner & 2) ? box.max.y : box.min.y,
+                           (corner & 4) ? box.max.z : box.min.z);
+        glm::vec4 clip = viewProjection * glm::vec4(position, 1.0f);
+        if (clip.w <= 0.0f || clip.z < -clip.w)
+            return true; // Reaches past the near plane, so it's in front of everything
+
+        glm::vec3 screen = toScreen(clip);
+        screenMin = glm::min(screenMin, glm::vec2(screen));
+        screenMax = glm::max(screenMax, glm::vec2(screen));
+        nearest = std::min(nearest, screen.z);
+    }
+
+    // Off screen entirely is the frustum test's business, not ours
+    if (screenMax.x < 0.0f || screenMax.y < 0.0f || screenMin.x > Width || screenMin.y > Height)
+        return true;
+
+    // Every pixel the rectangle touches, rounded outwards
+    int x0 = std::max(0, static_cast<int>(std::floor(screenMin.x)));
+    int x1 = std::min(Width - 1, static_cast<int>(std::floor(screenMax.x)));
+    int y0 = std::max(0, static_cast<int>(std::floor(screenMin.y)));
+    int y1 = std::min(Height - 1, static_cast<int>(std::floor(screenMax.y)));
+    int tx0 = x0 / TileWidth;
+    int tx1 = x1 / TileWidth;
+    int ty0 = y0 / TileHeight;
+    int ty1 = y1 / TileHeight;
+
+    switch (instructionSet())
+    {
+#ifdef OCCLUSION_AVX2
+    case InstructionSet::Avx2:
+        return anyTileBehindAvx2(tiles.data(), tx0, tx1, ty0, ty1, nearest);
+#endif
+#ifdef OCCLUSION_SSE
+    case InstructionSet::Sse:
+        return anyTileBehindSse(tiles.data(), tx0, tx1, ty0, ty1, nearest);
+#endif
+    default:
+        return anyTileBehindScalar(tiles.data(), tx0, tx1, ty0, ty1, nearest);
+    }
+}
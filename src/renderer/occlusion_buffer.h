@@ -0,0 +1,66 @@
+/**
+ * @file occlusion_buffer.h
+ * @brief Low resolution software depth buffer for culling objects hidden behind occluders
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "../engine/math/bounds.h"
+
+class Mesh;
+
+/**
+ * @brief CPU-rasterized depth of the occluders in view, with a coarse max-depth level on top.
+ *
+ * Each frame, begin() clears the buffer and rasterize() draws occluder meshes into a small
+ * depth buffer. finish() then reduces every TileWidth x TileHeight tile to the farthest
+ * depth in it. isVisible() projects a world box to the screen and reports it hidden only
+ * if every tile it covers holds something nearer than the box's nearest point. Nothing is
+ * read back from the GPU, so results don't depend on the driver.
+ *
+ * The inner loops work on AVX2 registers (8 pixels at a time) when the CPU has AVX2, SSE
+ * (4) otherwise, and plain scalar code off x86. Anything the buffer can't be sure about
+ * counts as visible. isVisible() only reads, so it may run on several threads at once.
+ */
+class OcclusionBuffer
+{
+public:
+    static constexpr int Width = 256;
+    static constexpr int Height = 128;
+    static constexpr int TileWidth = 8;
+    static constexpr int TileHeight = 4;
+    static constexpr int TilesX = Width / TileWidth;
+    static constexpr int TilesY = Height / TileHeight;
+
+    OcclusionBuffer();
+
+    // Clear to the far plane and set the camera later calls project with
+    void begin(const glm::mat4 &viewProjection);
+
+    // Draw mesh's triangles; parts in front of the near plane are clipped away
+    void rasterize(const Mesh &mesh, const glm::mat4 &model);
+
+    // Build the tile level; call after the last rasterize() and before isVisible()
+    void finish();
+
+    // False if box is certainly hidden behind what was rasterized
+    bool isVisible(const BoundingBox &box) const;
+
+    // Triangles rasterized since begin()
+    size_t getTriangleCount() const { return triangleCount; }
+
+    // The inner loops this CPU runs: "AVX2", "SSE" or "scalar"
+    static const char *getInstructionSet();
+
+private:
+    // v0..v2 are in pixels, with depth from 0 at the near plane to 1 at the far one
+    void rasterizeTriangle(glm::vec3 v0, glm::vec3 v1, glm::vec3 v2);
+
+    glm::mat4 viewProjection{1.0f};
+    std::vector<float> depth;             // Width x Height, row-major, bottom row first
+    std::vector<float> tiles;             // TilesX x TilesY, farthest depth in each tile
+    std::vector<glm::vec4> clipPositions; // Scratch, the current mesh's vertices in clip space
+    size_t triangleCount = 0;
+};
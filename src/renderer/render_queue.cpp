@@ -0,0 +1,265 @@
+/**
+ * @file render_queue.cpp
+ * @brief Collects draw calls for a frame and submits them sorted by state
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "render_queue.h"
+
+RenderQueue::~RenderQueue()
+{
+    if (instanceBuffer)
+    {
+        GL().deleteBuffer(instanceBuffer);
+    }
+}
+
+void RenderQueue::setInstancing(Shader *base, Shader *instanced, size_t minimum)
+{
+    baseShader = base;
+    instancedShader = instanced;
+    minInstances = std::max<size_t>(1, minimum);
+}
+
+void RenderQueue::clear()
+{
+    items.clear();
+    entries.clear();
+}
+
+void RenderQueue::setFrame(const FrameUniforms &frame)
+{
+    frameBuffer.upload(&frame, sizeof(frame));
+    frameBuffer.bind(UniformBinding::Frame);
+}
+
+uint32_t RenderQueue::materialBits(const glm::vec3 &color)
+{
+    // There are no material objects yet, so draws with the same colour count as the same
+    // material. Colour lives in the per-draw Object block, so this only orders ties.
+    uint32_t r = static_cast<uint32_t>(glm::clamp(color.r, 0.0f, 1.0f) * 255.0f);
+    uint32_t g = static_cast<uint32_t>(glm::clamp(color.g, 0.0f, 1.0f) * 255.0f);
+    uint32_t b = static_cast<uint32_t>(glm::clamp(color.b, 0.0f, 1.0f) * 255.0f);
+    uint32_t hash = (r * 73856093u) ^ (g * 19349663u) ^ (b * 83492791u);
+    return hash & 0x3FFu;
+}
+
+uint64_t RenderQueue::makeKey(RenderPass pass, uint32_t shader, uint32_t material, uint32_t mesh, float viewDepth)
+{
+    // Non-negative floats order the same as their bit patterns
+    float depth = std::max(viewDepth, 0.0f);
+    uint32_t depthBits;
+    std::memcpy(&depthBits, &depth, sizeof(depthBits));
+
+    uint64_t state = (static_cast<uint64_t>(shader & 0xFFu) << 22) |
+                     (static_cast<uint64_t>(mesh & 0xFFFu) << 10) |
+                     static_cast<uint64_t>(material & 0x3FFu);
+    uint64_t passBits = static_cast<uint64_t>(pass) << 62;
+
+    if (pass == RenderPass::Transparent)
+    {
+        return passBits | (static_cast<uint64_t>(~depthBits) << 30) | state;
+    }
+    return passBits | (state << 32) | depthBits;
+}
+
+void RenderQueue::submit(RenderPass pass, Shader &shader, const Mesh &mesh, const glm::mat4 &model,
+                         const glm::mat3 &normalMatrix, const glm::vec3 &color, float viewDepth)
+{
+    uint32_t index = static_cast<uint32_t>(items.size());
+    items.push_back({&shader, &mesh, model, normalMatrix, color});
+    entries.push_back({makeKey(pass, shader.getSortId(), materialBits(color), mesh.getSortId(), viewDepth), index});
+}
+
+void RenderQueue::sort()
+{
+    size_t count = entries.size();
+    if (count < 2)
+        return;
+
+    scratch.resize(count);
+
+    // Bytes that are identical in every key can't change the order; skip those passes
+    uint64_t allOr = 0;
+    uint64_t allAnd = ~0ull;
+    for (const SortEntry &entry : entries)
+    {
+        allOr |= entry.key;
+        allAnd &= entry.key;
+    }
+    uint64_t varying = allOr ^ allAnd;
+
+    SortEntry *source = entries.data();
+    SortEntry *destination = scratch.data();
+    for (unsigned shift = 0; shift < 64; shift += 8)
+    {
+        if (((varying >> shift) & 0xFFu) == 0)
+            continue;
+
+        size_t offsets[256] = {};
+        for (size_t i = 0; i < count; ++i)
+        {
+            ++offsets[(source[i].key >> shift) & 0xFFu];
+        }
+
+        size_t total = 0;
+        for (size_t &offset : offsets)
+        {
+            size_t bucketSize = offset;
+            offset = total;
+            total += bucketSize;
+        }
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            destination[offsets[(source[i].key >> shift) & 0xFFu]++] = source[i];
+        }
+        std::swap(source, destination);
+    }
+
+    if (source != entries.data())
+    {
+        entries.swap(scratch);
+    }
+}
+
+void RenderQueue::buildBatches()
+{
+    batches.clear();
+    instances.clear();
+
+    uint32_t count = static_cast<uint32_t>(entries.size());
+    uint32_t first = 0;
+    while (first < count)
+    {
+        const DrawItem &head = items[entries[first].item];
+        uint32_t end = first + 1;
+        if (instancedShader && head.shader == baseShader)
+        {
+            while (end < count && items[entries[end].item].shader == head.shader &&
+                   items[entries[end].item].mesh == head.mesh)
+            {
+                ++end;
+            }
+        }
+
+        uint32_t runLength = end - first;
+        if (runLength >= minInstances && instancedShader && head.shader == baseShader)
+        {
+            batches.push_back({first, runLength, static_cast<uint32_t>(instances.size()), true});
+            for (uint32_t i = first; i < end; ++i)
+            {
+                const DrawItem &item = items[entries[i].item];
+                instances.push_back({item.model, item.normalMatrix, item.color});
+            }
+        }
+        else
+        {
+            batches.push_back({first, runLength, 0, false});
+        }
+        first = end;
+    }
+}
+
+void RenderQueue::execute()
+{
+    stats = {};
+    buildBatches();
+
+    // One upload for every instanced batch of the frame
+    if (!instances.empty())
+    {
+        if (!instanceBuffer)
+        {
+            glGenBuffers(1, &instanceBuffer);
+        }
+        GL().bindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+        if (instances.size() > instanceBufferCapacity)
+        {
+            instanceBufferCapacity = instances.size() + instances.size() / 2;
+        }
+        // Orphan last frame's storage so the driver doesn't wait for draws still using it
+        glBufferData(GL_ARRAY_BUFFER, instanceBufferCapacity * sizeof(InstanceData), nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, instances.size() * sizeof(InstanceData), instances.data());
+    }
+
+    // Likewise one upload for the Object block of every draw that isn't instanced
+    size_t stride = UniformBuffer::alignedStride(sizeof(ObjectUniforms));
+    objectData.resize(entries.size() * stride);
+    size_t objectCount = 0;
+    for (const Batch &batch : batches)
+    {
+        if (batch.instanced)
+            continue;
+
+        for (uint32_t i = batch.firstEntry; i < batch.firstEntry + batch.entryCount; ++i)
+        {
+            const DrawItem &item = items[entries[i].item];
+            ObjectUniforms object;
+            object.model = item.model;
+            object.normalMatrix = glm::mat3x4(item.normalMatrix);
+            object.color = glm::vec4(item.color, 1.0f);
+            std::memcpy(objectData.data() + objectCount++ * stride, &object, sizeof(object));
+        }
+    }
+    if (objectCount > 0)
+    {
+        objectBuffer.upload(objectData.data(), objectCount * stride);
+    }
+
+    Shader *currentShader = nullptr;
+    const Mesh *currentMesh = nullptr;
+    size_t objectIndex = 0;
+
+    auto useShader = [&](Shader *shader)
+    {
+        if (shader != currentShader)
+        {
+            currentShader = shader;
+            currentShader->use();
+            ++stats.shaderChanges;
+        }
+    };
+    auto bindMesh = [&](const Mesh *mesh)
+    {
+        if (mesh != currentMesh)
+        {
+            currentMesh = mesh;
+            currentMesh->bind();
+            ++stats.meshChanges;
+        }
+    };
+
+    for (const Batch &batch : batches)
+    {
+        const DrawItem &head = items[entries[batch.firstEntry].item];
+        if (batch.instanced)
+        {
+            useShader(instancedShader);
+            bindMesh(head.mesh);
+            head.mesh->setInstanceBuffer(instanceBuffer, batch.firstInstance);
+            head.mesh->drawInstancedBound(batch.entryCount);
+            ++stats.draws;
+            ++stats.instancedDraws;
+            continue;
+        }
+
+        for (uint32_t i = batch.firstEntry; i < batch.firstEntry + batch.entryCount; ++i)
+        {
+            const DrawItem &item = items[entries[i].item];
+            useShader(item.shader);
+            bindMesh(item.mesh);
+
+            objectBuffer.bindRange(UniformBinding::Object, objectIndex++ * stride, sizeof(ObjectUniforms));
+            currentMesh->drawBound();
+            ++stats.draws;
+        }
+    }
+
+    if (currentMesh)
+    {
+        Mesh::unbind();
+    }
+}
@@ -0,0 +1,131 @@
+/**
+ * @file render_queue.h
+ * @brief Collects draw calls for a frame and submits them sorted by state
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "shader.h"
+#include "mesh.h"
+#include "uniform_buffer.h"
+
+enum class RenderPass : uint8_t
+{
+    Opaque = 0,     // Sorted by state, then front to back
+    Transparent = 1 // Sorted back to front, then by state
+};
+
+/**
+ * @brief One frame's worth of draws, reordered to minimize state changes.
+ *
+ * Each submitted draw gets a 64-bit key:
+ *
+ *     Opaque:      pass:2 | shader:8 | mesh:12 | material:10 | depth:32
+ *     Transparent: pass:2 | ~depth:32 | shader:8 | mesh:12 | material:10
+ *
+ * so sorting the keys groups opaque draws by shader, then mesh, then material, nearest
+ * first within a group, and orders transparent draws back to front. Keys are sorted with
+ * an LSD radix sort that skips bytes every key shares. execute() then only switches the
+ * shader or vertex array when the next draw needs a different one.
+ *
+ * Per-draw data doesn't go through glUniform calls: execute() packs every draw's
+ * ObjectUniforms into one uniform buffer, uploads it once, and binds each draw's slice to
+ * the Object block. Camera and light go into the Frame block via setFrame().
+ *
+ * With setInstancing(), runs of consecutive draws that share the base shader and mesh
+ * become one glDrawElementsInstanced with the instanced shader. Their model matrices,
+ * normal matrices and colours go into a single instance buffer uploaded once per frame.
+ *
+ * The queue keeps its buffers between frames; clear() it at the start of each one.
+ */
+class RenderQueue
+{
+public:
+    struct Stats
+    {
+        size_t draws = 0;
+        size_t shaderChanges = 0;
+        size_t meshChanges = 0;
+        size_t instancedDraws = 0; // Included in draws
+    };
+
+    RenderQueue() = default;
+    ~RenderQueue();
+
+    RenderQueue(const RenderQueue &) = delete;
+    RenderQueue &operator=(const RenderQueue &) = delete;
+
+    /**
+     * @brief Draw runs of base-shader draws that share a mesh with instanced instead.
+     * @param instanced Shader reading InstanceData attributes; nullptr turns instancing off.
+     * @param minInstances Shorter runs are drawn one by one.
+     */
+    void setInstancing(Shader *base, Shader *instanced, size_t minInstances = 2);
+
+    void clear();
+
+    // Upload camera and light and bind them to the Frame block, for this and later draws
+    void setFrame(const FrameUniforms &frame);
+
+    /**
+     * @param viewDepth Any value that grows with distance from the camera, e.g. squared distance.
+     */
+    void submit(RenderPass pass, Shader &shader, const Mesh &mesh, const glm::mat4 &model,
+                const glm::mat3 &normalMatrix, const glm::vec3 &color, float viewDepth);
+
+    void sort();
+
+    // Issue the draws in sorted order. Call setFrame() first.
+    void execute();
+
+    size_t size() const { return items.size(); }
+    const Stats &getStats() const { return stats; }
+
+private:
+    struct DrawItem
+    {
+        Shader *shader;
+        const Mesh *mesh;
+        glm::mat4 model;
+        glm::mat3 normalMatrix;
+        glm::vec3 color;
+    };
+
+    struct SortEntry
+    {
+        uint64_t key;
+        uint32_t item;
+    };
+
+    // A run of sorted entries drawn with one call, or one by one when not instanced
+    struct Batch
+    {
+        uint32_t firstEntry;
+        uint32_t entryCount;
+        uint32_t firstInstance; // Into instances, when instanced
+        bool instanced;
+    };
+
+    void buildBatches();
+
+    static uint64_t makeKey(RenderPass pass, uint32_t shader, uint32_t material, uint32_t mesh, float viewDepth);
+    static uint32_t materialBits(const glm::vec3 &color);
+
+    std::vector<DrawItem> items;
+    std::vector<SortEntry> entries;
+    std::vector<SortEntry> scratch; // Radix sort ping-pong buffer
+    std::vector<Batch> batches;
+    std::vector<InstanceData> instances;
+    Shader *baseShader = nullptr;
+    Shader *instancedShader = nullptr;
+    size_t minInstances = 2;
+    GLuint instanceBuffer = 0;
+    size_t instanceBufferCapacity = 0; // In instances
+    std::vector<unsigned char> objectData; // ObjectUniforms at the buffer's offset alignment
+    UniformBuffer objectBuffer;
+    UniformBuffer frameBuffer;
+    Stats stats;
+};
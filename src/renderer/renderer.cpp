@@ -4,6 +4,7 @@
  */
 
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/matrix_inverse.hpp>
 
 #include "renderer.h"
 #include "../engine/resourcemanager.h"
@@ -26,6 +27,11 @@ void Renderer::initialize(int width, int height)
     Resources().addShader("basic", basicShader);
     shader = basicShader;
 
+    // Same lighting, with per-object data read from instance attributes
+    auto instancedShaderPtr = std::make_shared<Shader>("src/shaders/basic_instanced.vert", "src/shaders/basic.frag");
+    Resources().addShader("basic_instanced", instancedShaderPtr);
+    instancedShader = instancedShaderPtr;
+
     // Create and initialize the outline shader
     auto outlineShaderPtr = std::make_shared<Shader>("src/shaders/outline.vert", "src/shaders/outline.frag");
     Resources().addShader("outline", outlineShaderPtr);
@@ -47,14 +53,14 @@ void Renderer::initialize(int width, int height)
     sphere = sphereMesh;
 
     // Set initial viewport
-    glViewport(0, 0, width, height);
+    GL().viewport(0, 0, width, height);
 }
 
 void Renderer::resize(int width, int height)
 {
     viewportWidth = width;
     viewportHeight = height;
-    glViewport(0, 0, width, height);
+    GL().viewport(0, 0, width, height);
 }
 
 void Renderer::render(bool useSphere)
@@ -65,19 +71,20 @@ void Renderer::render(bool useSphere)
     shader->use();
 
     // Set camera matrices
-    glm::mat4 projection = glm::perspective(glm::radians(45.0f),
-                                            static_cast<float>(viewportWidth) / static_cast<float>(viewportHeight),
-                                            0.1f, 100.0f);
-    shader->setMat4("projection", projection);
-    shader->setMat4("view", camera.getViewMatrix());
+    FrameUniforms frame;
+    frame.projection = glm::perspective(glm::radians(45.0f),
+                                        static_cast<float>(viewportWidth) / static_cast<float>(viewportHeight),
+                                        0.1f, 100.0f);
+    frame.view = camera.getViewMatrix();
 
     // Set camera position for specular lighting
-    shader->setVec3("viewPos", camera.getPosition());
+    frame.viewPos = glm::vec4(camera.getPosition(), 1.0f);
 
     // Set light properties
-    shader->setVec3("lightPos", lightPos);
-    shader->setVec3("lightColor", lightColor);
-    shader->setVec3("objectColor", objectColor);
+    frame.lightPos = glm::vec4(lightPos, 1.0f);
+    frame.lightColor = glm::vec4(lightColor, 1.0f);
+    frameBuffer.upload(&frame, sizeof(frame));
+    frameBuffer.bind(UniformBinding::Frame);
 
     // Set model matrix
     glm::mat4 model = glm::mat4(1.0f);
@@ -89,7 +96,13 @@ void Renderer::render(bool useSphere)
     model = glm::rotate(model, glm::radians(objectRotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
 
     model = glm::scale(model, objectScale);
-    shader->setMat4("model", model);
+
+    ObjectUniforms object;
+    object.model = model;
+    object.normalMatrix = glm::mat3x4(glm::inverseTranspose(glm::mat3(model)));
+    object.color = glm::vec4(objectColor, 1.0f);
+    objectBuffer.upload(&object, sizeof(object));
+    objectBuffer.bind(UniformBinding::Object);
 
     // Get meshes from resource manager
     auto sphereMesh = Resources().getMesh("Sphere");
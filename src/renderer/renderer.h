@@ -9,6 +9,7 @@
 #include "shader.h"
 #include "mesh.h"
 #include "camera.h"
+#include "uniform_buffer.h"
 
 class Renderer
 {
@@ -25,6 +26,9 @@ public:
     Shader *getShader() { return shader.get(); }
     const Shader *getShader() const { return shader.get(); }
 
+    // The basic shader with per-instance model, normal matrix and colour attributes
+    Shader *getInstancedShader() { return instancedShader.get(); }
+
     // Scene properties
     glm::vec3 lightPos{2.0f, 2.0f, 2.0f};
     glm::vec3 lightColor{1.0f, 1.0f, 1.0f};
@@ -48,10 +52,13 @@ private:
     void setupScene();
 
     std::shared_ptr<Shader> shader;
+    std::shared_ptr<Shader> instancedShader;
     std::shared_ptr<Shader> outlineShader;  // Shader for rendering outlines
     std::shared_ptr<Mesh> cube;
     std::shared_ptr<Mesh> sphere;
     Camera camera;
+    UniformBuffer frameBuffer;  // Used by render() only; scenes draw through their RenderQueue
+    UniformBuffer objectBuffer;
 
     int viewportWidth{1280};
     int viewportHeight{720};
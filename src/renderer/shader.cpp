@@ -3,15 +3,30 @@
  * @brief Shader class for handling shader programs
  */
 
+#include <algorithm>
 #include <fstream>
+#include <utility>
 #include <sstream>
 #include <iostream>
 #include <glm/gtc/type_ptr.hpp>
 
 #include "shader.h"
+#include "uniform_buffer.h"
 #include "../helpers/logging.h"
 
+namespace
+{
+    uint32_t nextSortId = 0;
+
+    template <typename T>
+    constexpr GLenum glTypeOf(const UniformHandle<T> &)
+    {
+        return UniformGLType<T>::value;
+    }
+}
+
 Shader::Shader(const char *vertexPath, const char *fragmentPath)
+    : sortId(nextSortId++)
 {
     std::string vertexCode;
     std::string fragmentCode;
@@ -87,38 +102,23 @@ Shader::Shader(const char *vertexPath, const char *fragmentPath)
     glLinkProgram(ID);
     checkCompileErrors(ID, "PROGRAM");
 
-    // Query and validate uniform locations before deleting shaders
-    GLint numUniforms;
-    glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &numUniforms);
-    // printf("Active uniforms in shader program %d:\n", ID);
-
-    // Pre-cache all uniform locations
-    const char *expectedUniforms[] = {
-        "model", "view", "projection", "viewPos",
-        "lightPos", "lightColor", "objectColor"};
+    // GLSL 330 can't give blocks a binding in the source, so attach them by name here.
+    // Every shader declaring the same block then reads the same buffer.
+    const std::pair<const char *, UniformBinding> blocks[] = {
+        {"Frame", UniformBinding::Frame},
+        {"Object", UniformBinding::Object}};
 
-    for (const char *uniformName : expectedUniforms)
+    for (const auto &[blockName, binding] : blocks)
     {
-        GLint location = glGetUniformLocation(ID, uniformName);
-        if (location == -1)
+        GLuint blockIndex = glGetUniformBlockIndex(ID, blockName);
+        if (blockIndex != GL_INVALID_INDEX)
         {
-            LOG_WARNING("Expected uniform {} not found in shader program", uniformName);
-            // logMessage(LogLevel::Warning, "Expected uniform '%s' not found in shader program", uniformName);
-            // printf("Warning: Expected uniform '%s' not found in shader program\n", uniformName);
+            glUniformBlockBinding(ID, blockIndex, static_cast<GLuint>(binding));
         }
-        uniformLocations[uniformName] = location;
     }
 
-    // // Print all active uniforms for debugging
-    // for (GLint i = 0; i < numUniforms; i++)
-    // {
-    //     GLchar name[128];
-    //     GLint size;
-    //     GLenum type;
-    //     glGetActiveUniform(ID, i, sizeof(name), NULL, &size, &type, name);
-    //     GLint location = glGetUniformLocation(ID, name);
-    //     logMessage(LogLevel::Debug, "Active uniform: %s (location: %d)", name, location);
-    // }
+    reflectUniforms();
+    resolveEngineUniforms();
 
     // Clean up shader objects
     glDeleteShader(vertex);
@@ -139,79 +139,203 @@ Shader::Shader(const char *vertexPath, const char *fragmentPath)
 
 Shader::~Shader()
 {
-    glDeleteProgram(ID);
+    GL().deleteProgram(ID);
 }
 
 void Shader::use()
 {
-    glUseProgram(ID);
+    GL().useProgram(ID);
 }
 
-GLint Shader::getUniformLocation(const std::string &name) const
+void Shader::reflectUniforms()
 {
-    // Check if we've already cached this uniform location
-    auto it = uniformLocations.find(name);
-    if (it != uniformLocations.end())
+    GLint count = 0;
+    GLint maxNameLength = 0;
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+    std::vector<GLchar> nameBuffer(static_cast<size_t>(std::max(maxNameLength, 1)));
+    for (GLint i = 0; i < count; i++)
     {
-        return it->second;
+        // Block members are set through their uniform buffer, not by location
+        GLuint index = static_cast<GLuint>(i);
+        GLint blockIndex = -1;
+        glGetActiveUniformsiv(ID, 1, &index, GL_UNIFORM_BLOCK_INDEX, &blockIndex);
+        if (blockIndex != -1)
+            continue;
+
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(ID, index, maxNameLength, &length, &size, &type, nameBuffer.data());
+
+        // Arrays are reported as "name[0]"; look them up by their plain name
+        std::string name(nameBuffer.data(), static_cast<size_t>(length));
+        if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0)
+        {
+            name.resize(name.size() - 3);
+        }
+
+        GLint location = glGetUniformLocation(ID, name.c_str());
+        uniforms.push_back({std::move(name), location, type, size});
     }
 
-    // Get the uniform location and cache it
-    GLint location = glGetUniformLocation(ID, name.c_str());
-    if (location == -1)
+    std::sort(uniforms.begin(), uniforms.end(),
+              [](const UniformInfo &a, const UniformInfo &b) { return a.name < b.name; });
+}
+
+void Shader::resolveEngineUniforms()
+{
+    std::vector<std::string_view> known;
+    auto resolve = [&](auto &handle, std::string_view name)
+    {
+        known.push_back(name);
+        const UniformInfo *info = findUniform(name);
+        if (!info)
+            return; // Not every shader uses every engine uniform
+        if (info->type != glTypeOf(handle))
+        {
+            reportUnknown(name, "has a different type than the engine sets");
+            return;
+        }
+        handle.location = info->location;
+    };
+
+    resolve(engineUniforms.outlineColor, "outlineColor");
+    resolve(engineUniforms.scaleFactor, "scaleFactor");
+
+    // Anything else keeps its default value unless set by name
+    for (const UniformInfo &info : uniforms)
     {
-        printf("Warning: Uniform '%s' not found in shader program %d\n", name.c_str(), ID);
+        if (std::find(known.begin(), known.end(), info.name) == known.end())
+        {
+            reportUnknown(info.name, "is not one the engine sets");
+        }
     }
-    uniformLocations[name] = location;
-    return location;
 }
 
-void Shader::setBool(const std::string &name, bool value) const
+const Shader::UniformInfo *Shader::findUniform(std::string_view name) const
 {
-    GLint location = getUniformLocation(name);
-    if (location != -1)
+    auto it = std::lower_bound(uniforms.begin(), uniforms.end(), name,
+                               [](const UniformInfo &info, std::string_view key) { return info.name < key; });
+    return it != uniforms.end() && it->name == name ? &*it : nullptr;
+}
+
+void Shader::reportUnknown(std::string_view name, const char *problem) const
+{
+    if (reported.find(name) != reported.end())
+        return;
+
+    reported.emplace(name);
+    LOG_WARNING("Uniform {} {} in shader program {}", std::string(name), problem, ID);
+}
+
+GLint Shader::resolveUniform(std::string_view name, GLenum type) const
+{
+    const UniformInfo *info = findUniform(name);
+    if (!info)
     {
-        glUniform1i(location, (int)value);
+        reportUnknown(name, "not found");
+        return -1;
     }
+    if (info->type != type)
+    {
+        reportUnknown(name, "has a different type than requested");
+        return -1;
+    }
+    return info->location;
 }
 
-void Shader::setInt(const std::string &name, int value) const
+GLint Shader::getUniformLocation(std::string_view name) const
 {
-    GLint location = getUniformLocation(name);
-    if (location != -1)
+    const UniformInfo *info = findUniform(name);
+    if (!info)
     {
-        glUniform1i(location, value);
+        reportUnknown(name, "not found");
+        return -1;
     }
+    return info->location;
 }
 
-void Shader::setFloat(const std::string &name, float value) const
+void Shader::set(UniformHandle<bool> handle, bool value) const
 {
-    GLint location = getUniformLocation(name);
-    if (location != -1)
+    if (handle.isValid())
     {
-        glUniform1f(location, value);
+        glUniform1i(handle.location, (int)value);
     }
 }
 
-void Shader::setVec3(const std::string &name, const glm::vec3 &value) const
+void Shader::set(UniformHandle<int> handle, int value) const
 {
-    GLint location = getUniformLocation(name);
-    if (location != -1)
+    if (handle.isValid())
     {
-        glUniform3fv(location, 1, glm::value_ptr(value));
+        glUniform1i(handle.location, value);
     }
 }
 
-void Shader::setMat4(const std::string &name, const glm::mat4 &mat) const
+void Shader::set(UniformHandle<float> handle, float value) const
 {
-    GLint location = getUniformLocation(name);
-    if (location != -1)
+    if (handle.isValid())
+    {
+        glUniform1f(handle.location, value);
+    }
+}
+
+void Shader::set(UniformHandle<glm::vec3> handle, const glm::vec3 &value) const
+{
+    if (handle.isValid())
+    {
+        glUniform3fv(handle.location, 1, glm::value_ptr(value));
+    }
+}
+
+void Shader::set(UniformHandle<glm::mat3> handle, const glm::mat3 &mat) const
+{
+    if (handle.isValid())
+    {
+        glUniformMatrix3fv(handle.location, 1, GL_FALSE, glm::value_ptr(mat));
+    }
+}
+
+void Shader::set(UniformHandle<glm::mat4> handle, const glm::mat4 &mat) const
+{
+    if (handle.isValid())
     {
-        glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(mat));
+        glUniformMatrix4fv(handle.location, 1, GL_FALSE, glm::value_ptr(mat));
     }
 }
 
-glm::mat4 Shader::getUniformMat4(const std::string &name) const
+void Shader::setBool(std::string_view name, bool value) const
+{
+    set(UniformHandle<bool>{getUniformLocation(name)}, value);
+}
+
+void Shader::setInt(std::string_view name, int value) const
+{
+    set(UniformHandle<int>{getUniformLocation(name)}, value);
+}
+
+void Shader::setFloat(std::string_view name, float value) const
+{
+    set(UniformHandle<float>{getUniformLocation(name)}, value);
+}
+
+void Shader::setVec3(std::string_view name, const glm::vec3 &value) const
+{
+    set(UniformHandle<glm::vec3>{getUniformLocation(name)}, value);
+}
+
+void Shader::setMat3(std::string_view name, const glm::mat3 &mat) const
+{
+    set(UniformHandle<glm::mat3>{getUniformLocation(name)}, mat);
+}
+
+void Shader::setMat4(std::string_view name, const glm::mat4 &mat) const
+{
+    set(UniformHandle<glm::mat4>{getUniformLocation(name)}, mat);
+}
+
+glm::mat4 Shader::getUniformMat4(std::string_view name) const
 {
     glm::mat4 value;
     GLint location = getUniformLocation(name);
@@ -222,7 +346,7 @@ glm::mat4 Shader::getUniformMat4(const std::string &name) const
     return value;
 }
 
-glm::vec3 Shader::getUniformVec3(const std::string &name) const
+glm::vec3 Shader::getUniformVec3(std::string_view name) const
 {
     glm::vec3 value;
     GLint location = getUniformLocation(name);
@@ -4,12 +4,49 @@
  */
 
 #pragma once
+#include <cstdint>
+#include <set>
 #include <string>
-#include <unordered_map>
+#include <string_view>
+#include <vector>
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
+#include "gl_state.h"
+
+// GL type a uniform must be declared with to be set from a T
+template <typename T>
+struct UniformGLType;
+template <> struct UniformGLType<bool> { static constexpr GLenum value = GL_BOOL; };
+template <> struct UniformGLType<int> { static constexpr GLenum value = GL_INT; };
+template <> struct UniformGLType<float> { static constexpr GLenum value = GL_FLOAT; };
+template <> struct UniformGLType<glm::vec3> { static constexpr GLenum value = GL_FLOAT_VEC3; };
+template <> struct UniformGLType<glm::mat3> { static constexpr GLenum value = GL_FLOAT_MAT3; };
+template <> struct UniformGLType<glm::mat4> { static constexpr GLenum value = GL_FLOAT_MAT4; };
+
+/**
+ * @brief A uniform location resolved once, for setting a T without a name lookup.
+ *
+ * A default or unresolved handle is invalid and setting it does nothing, like setting a
+ * uniform the compiler optimized away.
+ */
+template <typename T>
+struct UniformHandle
+{
+    GLint location = -1;
+
+    bool isValid() const { return location != -1; }
+};
+
+// Uniforms the engine sets outside the Frame and Object blocks, resolved when a shader
+// loads. Those a program doesn't declare keep an invalid handle.
+struct EngineUniforms
+{
+    UniformHandle<glm::vec3> outlineColor;
+    UniformHandle<float> scaleFactor;
+};
+
 class Shader
 {
 public:
@@ -17,23 +54,75 @@ public:
     ~Shader();
 
     void use();
-    void setBool(const std::string &name, bool value) const;
-    void setInt(const std::string &name, int value) const;
-    void setFloat(const std::string &name, float value) const;
-    void setVec3(const std::string &name, const glm::vec3 &value) const;
-    void setMat4(const std::string &name, const glm::mat4 &mat) const;
+
+    /**
+     * @brief Resolve a uniform declared outside any block to a typed handle.
+     *
+     * Looks the name up in the table reflected at link time. Names the program doesn't
+     * declare, or declares with a type other than T, are reported once per shader and
+     * give an invalid handle.
+     */
+    template <typename T>
+    UniformHandle<T> getUniform(std::string_view name) const
+    {
+        return {resolveUniform(name, UniformGLType<T>::value)};
+    }
+
+    // Handles for everything the engine sets, so per-draw code never looks a name up
+    const EngineUniforms &getEngineUniforms() const { return engineUniforms; }
+
+    // Set a resolved uniform on this program, which must be in use. No lookup, no allocation.
+    void set(UniformHandle<bool> handle, bool value) const;
+    void set(UniformHandle<int> handle, int value) const;
+    void set(UniformHandle<float> handle, float value) const;
+    void set(UniformHandle<glm::vec3> handle, const glm::vec3 &value) const;
+    void set(UniformHandle<glm::mat3> handle, const glm::mat3 &mat) const;
+    void set(UniformHandle<glm::mat4> handle, const glm::mat4 &mat) const;
+
+    // By-name setters for code that runs rarely; each call searches the reflected table
+    void setBool(std::string_view name, bool value) const;
+    void setInt(std::string_view name, int value) const;
+    void setFloat(std::string_view name, float value) const;
+    void setVec3(std::string_view name, const glm::vec3 &value) const;
+    void setMat3(std::string_view name, const glm::mat3 &mat) const;
+    void setMat4(std::string_view name, const glm::mat4 &mat) const;
 
     // Get uniform values
-    glm::mat4 getUniformMat4(const std::string &name) const;
-    glm::vec3 getUniformVec3(const std::string &name) const;
+    glm::mat4 getUniformMat4(std::string_view name) const;
+    glm::vec3 getUniformVec3(std::string_view name) const;
 
 public:
     // Get the shader program ID
     unsigned int getProgramID() const { return ID; }
-    GLint getUniformLocation(const std::string &name) const;
+
+    // Small per-shader number the render queue groups draws by
+    uint32_t getSortId() const { return sortId; }
+
+    // -1 if the program has no such uniform outside a block; reported once
+    GLint getUniformLocation(std::string_view name) const;
 
 private:
+    // An active uniform outside any block, as reflected after linking
+    struct UniformInfo
+    {
+        std::string name;
+        GLint location;
+        GLenum type;
+        GLint size; // Array length, 1 for non-arrays
+    };
+
+    void reflectUniforms();
+
+    // Fill engineUniforms, and report declared uniforms the engine never sets
+    void resolveEngineUniforms();
+    const UniformInfo *findUniform(std::string_view name) const;
+    GLint resolveUniform(std::string_view name, GLenum type) const;
+    void reportUnknown(std::string_view name, const char *problem) const;
+
     unsigned int ID;
-    mutable std::unordered_map<std::string, GLint> uniformLocations;
+    uint32_t sortId;
+    std::vector<UniformInfo> uniforms; // Sorted by name
+    EngineUniforms engineUniforms;
+    mutable std::set<std::string, std::less<>> reported; // Names already warned about; found by string_view
     void checkCompileErrors(unsigned int shader, std::string type);
 };
@@ -0,0 +1,52 @@
+/**
+ * @file uniform_buffer.cpp
+ * @brief Uniform buffer objects and the std140 blocks the shaders share
+ */
+#include "uniform_buffer.h"
+#include "gl_state.h"
+
+UniformBuffer::~UniformBuffer()
+{
+    if (buffer)
+    {
+        GL().deleteBuffer(buffer);
+    }
+}
+
+void UniformBuffer::upload(const void *data, size_t size)
+{
+    if (!buffer)
+    {
+        glGenBuffers(1, &buffer);
+    }
+    if (size > capacity)
+    {
+        capacity = size + size / 2;
+    }
+
+    GL().bindBuffer(GL_UNIFORM_BUFFER, buffer);
+    glBufferData(GL_UNIFORM_BUFFER, capacity, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, size, data);
+}
+
+void UniformBuffer::bind(UniformBinding binding) const
+{
+    GL().bindUniformBufferBase(static_cast<GLuint>(binding), buffer);
+}
+
+void UniformBuffer::bindRange(UniformBinding binding, size_t offset, size_t size) const
+{
+    GL().bindUniformBufferRange(static_cast<GLuint>(binding), buffer,
+                                static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size));
+}
+
+size_t UniformBuffer::getOffsetAlignment()
+{
+    static size_t alignment = []()
+    {
+        GLint value = 0;
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &value);
+        return value > 0 ? static_cast<size_t>(value) : size_t(256);
+    }();
+    return alignment;
+}
@@ -0,0 +1,73 @@
+/**
+ * @file uniform_buffer.h
+ * @brief Uniform buffer objects and the std140 blocks the shaders share
+ */
+#pragma once
+#include <cstddef>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// Binding points every shader's blocks are attached to, see Shader's constructor
+enum class UniformBinding : GLuint
+{
+    Frame = 0, // "Frame" block: camera and light, bound once per frame
+    Object = 1 // "Object" block: one draw's transform and colour
+};
+
+// Mirrors the std140 "Frame" block. vec3s are padded to vec4 as std140 lays them out.
+struct FrameUniforms
+{
+    glm::mat4 view{1.0f};
+    glm::mat4 projection{1.0f};
+    glm::vec4 viewPos{0.0f};    // xyz
+    glm::vec4 lightPos{0.0f};   // xyz
+    glm::vec4 lightColor{1.0f}; // rgb, intensity already applied
+};
+
+// Mirrors the std140 "Object" block. A std140 mat3 is three vec4 columns, i.e. a mat3x4.
+struct ObjectUniforms
+{
+    glm::mat4 model{1.0f};
+    glm::mat3x4 normalMatrix{1.0f};
+    glm::vec4 color{1.0f}; // rgb
+};
+
+static_assert(sizeof(FrameUniforms) == 176, "FrameUniforms must match the std140 Frame block");
+static_assert(sizeof(ObjectUniforms) == 128, "ObjectUniforms must match the std140 Object block");
+
+/**
+ * @brief A GL_UNIFORM_BUFFER that grows to fit what is uploaded into it.
+ *
+ * upload() orphans the old storage before writing, so a buffer rewritten every frame
+ * doesn't make the driver wait for draws that still read last frame's contents.
+ */
+class UniformBuffer
+{
+public:
+    UniformBuffer() = default;
+    ~UniformBuffer();
+
+    UniformBuffer(const UniformBuffer &) = delete;
+    UniformBuffer &operator=(const UniformBuffer &) = delete;
+
+    void upload(const void *data, size_t size);
+
+    // Attach the whole buffer, or size bytes from offset, to a binding point
+    void bind(UniformBinding binding) const;
+    void bindRange(UniformBinding binding, size_t offset, size_t size) const;
+
+    // Offsets passed to bindRange must be multiples of this
+    static size_t getOffsetAlignment();
+
+    // Bytes between consecutive records of size bytes packed into one buffer
+    static size_t alignedStride(size_t size)
+    {
+        size_t alignment = getOffsetAlignment();
+        return (size + alignment - 1) / alignment * alignment;
+    }
+
+private:
+    GLuint buffer = 0;
+    size_t capacity = 0;
+};
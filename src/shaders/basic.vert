@@ -4,10 +4,25 @@ layout (location = 1) in vec3 aNormal;
 
 out vec3 FragPos;
 out vec3 Normal;
+out vec3 Color;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+// Per-frame data, see FrameUniforms in uniform_buffer.h
+layout (std140) uniform Frame
+{
+    mat4 view;
+    mat4 projection;
+    vec4 viewPos;
+    vec4 lightPos;
+    vec4 lightColor;
+};
+
+// Per-draw data, see ObjectUniforms in uniform_buffer.h
+layout (std140) uniform Object
+{
+    mat4 model;
+    mat3 normalMatrix; // inverse(transpose(mat3(model))), computed on the CPU per object
+    vec4 objectColor;
+};
 
 void main()
 {
@@ -15,8 +30,8 @@ void main()
     FragPos = vec3(model * vec4(aPos, 1.0));
     
     // Transform normal to world space (excluding translation)
-    // Using transpose(inverse(mat3(model))) for correct normal transformation
-    Normal = mat3(transpose(inverse(model))) * aNormal;
+    Normal = normalMatrix * aNormal;
+    Color = objectColor.rgb;
     
     // Calculate final position
     gl_Position = projection * view * vec4(FragPos, 1.0);
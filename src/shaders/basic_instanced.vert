@@ -0,0 +1,31 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+
+// Per-instance attributes, see InstanceData in mesh.h
+layout (location = 2) in mat4 aModel;        // Locations 2-5
+layout (location = 6) in mat3 aNormalMatrix; // Locations 6-8
+layout (location = 9) in vec3 aColor;
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec3 Color;
+
+// Per-frame data, see FrameUniforms in uniform_buffer.h
+layout (std140) uniform Frame
+{
+    mat4 view;
+    mat4 projection;
+    vec4 viewPos;
+    vec4 lightPos;
+    vec4 lightColor;
+};
+
+void main()
+{
+    // Same as basic.vert, with model, normal matrix and colour coming from the instance
+    FragPos = vec3(aModel * vec4(aPos, 1.0));
+    Normal = aNormalMatrix * aNormal;
+    Color = aColor;
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
@@ -2,9 +2,23 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+// Shares the camera with basic.vert, see FrameUniforms in uniform_buffer.h
+layout (std140) uniform Frame
+{
+    mat4 view;
+    mat4 projection;
+    vec4 viewPos;
+    vec4 lightPos;
+    vec4 lightColor;
+};
+
+layout (std140) uniform Object
+{
+    mat4 model;
+    mat3 normalMatrix;
+    vec4 objectColor;
+};
+
 uniform float scaleFactor;
 
 void main()